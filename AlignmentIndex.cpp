@@ -0,0 +1,81 @@
+#include "AlignmentIndex.h"
+
+void AlignmentIndex::insert(Uint32 id, const SDL_Rect& rect)
+{
+	_listed.push_back(rect);
+	_current.push_back(rect);
+	_states.push_back(State::New);
+	_dirty.push_back(id);
+}
+
+void AlignmentIndex::update(Uint32 id, const SDL_Rect& rect)
+{
+	_current[id] = rect;
+	if (_states[id] == State::Listed)
+	{
+		_states[id] = State::Moved;
+		_dirty.push_back(id);
+	}
+}
+
+void AlignmentIndex::apply(Uint32 id)
+{
+	if (_states[id] == State::Moved)
+	{
+		removeEntries(id, _listed[id]);
+	}
+	_listed[id] = _current[id];
+	addEntries(id, _listed[id]);
+	_states[id] = State::Listed;
+}
+
+void AlignmentIndex::rebuild()
+{
+	for (int axis = 0; axis < AxisCount; ++axis)
+	{
+		for (int feature = 0; feature < FeatureCount; ++feature)
+		{
+			std::vector<Entry>& list = _lists[axis][feature];
+			list.clear();
+			for (Uint32 id = 0; id < _current.size(); ++id)
+			{
+				list.push_back({ getCoordinate(_current[id], static_cast<Axis>(axis), static_cast<Feature>(feature)), id });
+			}
+			std::sort(list.begin(), list.end());
+		}
+	}
+
+	_listed = _current;
+	std::fill(_states.begin(), _states.end(), State::Listed);
+	_dirty.clear();
+}
+
+void AlignmentIndex::addEntries(Uint32 id, const SDL_Rect& rect)
+{
+	for (int axis = 0; axis < AxisCount; ++axis)
+	{
+		for (int feature = 0; feature < FeatureCount; ++feature)
+		{
+			std::vector<Entry>& list = _lists[axis][feature];
+			Entry entry = { getCoordinate(rect, static_cast<Axis>(axis), static_cast<Feature>(feature)), id };
+			list.insert(std::lower_bound(list.begin(), list.end(), entry), entry);
+		}
+	}
+}
+
+void AlignmentIndex::removeEntries(Uint32 id, const SDL_Rect& rect)
+{
+	for (int axis = 0; axis < AxisCount; ++axis)
+	{
+		for (int feature = 0; feature < FeatureCount; ++feature)
+		{
+			std::vector<Entry>& list = _lists[axis][feature];
+			Entry entry = { getCoordinate(rect, static_cast<Axis>(axis), static_cast<Feature>(feature)), id };
+			auto it = std::lower_bound(list.begin(), list.end(), entry);
+			if (it != list.end() && it->id == id && it->value == entry.value)
+			{
+				list.erase(it);
+			}
+		}
+	}
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "Snapping.h"
+
+// Every rect's left, center and right coordinate, and top, middle and bottom,
+// each kept in its own sorted list, so the nearest rect sharing one of them
+// with a dragged rect is a binary search away instead of a pairwise test.
+//
+// Moves are only recorded when they happen. refresh() folds them into the
+// lists before a search, leaving out the rects the search will skip anyway,
+// which are the ones being dragged, so a drag does not shift the lists on
+// every step.
+class AlignmentIndex
+{
+public:
+	enum Axis { Horizontal, Vertical, AxisCount };
+	enum Feature { Start, Center, End, FeatureCount };
+
+	static int getCoordinate(const SDL_Rect& rect, Axis axis, Feature feature)
+	{
+		int start = axis == Horizontal ? rect.x : rect.y;
+		int size = axis == Horizontal ? rect.w : rect.h;
+		return feature == Start ? start : feature == Center ? start + size / 2 : start + size;
+	}
+
+	// Ids are dense and assigned by the caller in insertion order.
+	void insert(Uint32 id, const SDL_Rect& rect);
+	void update(Uint32 id, const SDL_Rect& rect);
+
+	// Brings the lists up to date with every move except those of ids skip()
+	// accepts, which stay pending until a later call.
+	template <typename Skip>
+	void refresh(Skip&& skip)
+	{
+		size_t pending = 0;
+		size_t due = 0;
+		for (Uint32 id : _dirty)
+		{
+			if (skip(id))
+			{
+				++pending;
+			}
+			else
+			{
+				++due;
+			}
+		}
+
+		if (due > RebuildThreshold)
+		{
+			rebuild();
+			return;
+		}
+
+		// Pending ids are packed to the front and the rest applied.
+		size_t kept = 0;
+		for (Uint32 id : _dirty)
+		{
+			if (skip(id))
+			{
+				_dirty[kept++] = id;
+			}
+			else
+			{
+				apply(id);
+			}
+		}
+		_dirty.resize(kept);
+	}
+
+	// Offers to snap along axis so that the dragged rect's feature, now at
+	// value with the rect's own position at position, lines up with the same
+	// feature of another rect at most threshold away. Ids skip() accepts are
+	// passed over; the lists must have been refreshed with the same skip().
+	template <typename Skip>
+	void offerAlignments(Axis axis, Feature feature, int value, int position, int threshold, AxisSnap& snap, Skip&& skip) const
+	{
+		// Walk outwards from value on both sides while an entry could still
+		// beat, or tie with, the best offer so far.
+		const std::vector<Entry>& list = _lists[axis][feature];
+		auto middle = std::lower_bound(list.begin(), list.end(), value,
+			[](const Entry& entry, int coordinate) { return entry.value < coordinate; });
+		for (auto it = middle; it != list.end(); ++it)
+		{
+			int distance = it->value - value;
+			if (distance > threshold || distance > snap.distance)
+			{
+				break;
+			}
+			if (!skip(it->id))
+			{
+				snap.offer(position + distance, distance, it->id);
+			}
+		}
+		for (auto it = middle; it != list.begin();)
+		{
+			--it;
+			int distance = value - it->value;
+			if (distance > threshold || distance > snap.distance)
+			{
+				break;
+			}
+			if (!skip(it->id))
+			{
+				snap.offer(position - distance, distance, it->id);
+			}
+		}
+	}
+
+	static constexpr Uint32 NoId = UINT32_MAX;
+
+	// The rect an id's entries were made from; current unless it is one the
+	// last refresh() skipped.
+	const SDL_Rect& getRect(Uint32 id) const { return _listed[id]; }
+
+	// Nearest rect wholly before (or after) rect along axis that overlaps it
+	// across the axis, allowed to reach slack into it, or NoId. Gives up after
+	// MaxNeighborScan entries, so a sparse row costs a bounded walk on top of
+	// the binary search.
+	template <typename Skip>
+	Uint32 findNeighbor(Axis axis, bool after, const SDL_Rect& rect, int slack, Skip&& skip) const
+	{
+		Axis across = axis == Horizontal ? Vertical : Horizontal;
+		int start = getCoordinate(rect, axis, Start);
+		int end = getCoordinate(rect, axis, End);
+		auto isNeighbor = [&](Uint32 id)
+			{
+				const SDL_Rect& other = _listed[id];
+				// Geometry first; skip() tends to cost a look at the component.
+				return getCoordinate(other, across, Start) < getCoordinate(rect, across, End) &&
+					getCoordinate(rect, across, Start) < getCoordinate(other, across, End) &&
+					(after ? getCoordinate(other, axis, End) > end : getCoordinate(other, axis, Start) < start) &&
+					!skip(id);
+			};
+
+		int scanned = 0;
+		if (after)
+		{
+			const std::vector<Entry>& list = _lists[axis][Start];
+			auto it = std::lower_bound(list.begin(), list.end(), end - slack,
+				[](const Entry& entry, int coordinate) { return entry.value < coordinate; });
+			for (; it != list.end() && scanned < MaxNeighborScan; ++it, ++scanned)
+			{
+				if (isNeighbor(it->id))
+				{
+					return it->id;
+				}
+			}
+		}
+		else
+		{
+			const std::vector<Entry>& list = _lists[axis][End];
+			auto it = std::upper_bound(list.begin(), list.end(), start + slack,
+				[](int coordinate, const Entry& entry) { return coordinate < entry.value; });
+			while (it != list.begin() && scanned < MaxNeighborScan)
+			{
+				--it;
+				++scanned;
+				if (isNeighbor(it->id))
+				{
+					return it->id;
+				}
+			}
+		}
+		return NoId;
+	}
+
+private:
+	// With more moves than this to catch up on, the lists are sorted afresh.
+	static constexpr size_t RebuildThreshold = 64;
+	static constexpr int MaxNeighborScan = 256;
+
+	struct Entry
+	{
+		int value;
+		Uint32 id;
+
+		bool operator<(const Entry& other) const { return value < other.value || (value == other.value && id < other.id); }
+	};
+
+	enum class State : Uint8 { Listed, Moved, New };
+
+	void apply(Uint32 id);
+	void rebuild();
+	void addEntries(Uint32 id, const SDL_Rect& rect);
+	void removeEntries(Uint32 id, const SDL_Rect& rect);
+
+	std::vector<Entry> _lists[AxisCount][FeatureCount];
+
+	// Per id: the rect its entries were made from, the rect it has now, and
+	// whether those differ.
+	std::vector<SDL_Rect> _listed;
+	std::vector<SDL_Rect> _current;
+	std::vector<State> _states;
+	std::vector<Uint32> _dirty;
+};
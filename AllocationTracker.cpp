@@ -0,0 +1,251 @@
+#include "AllocationTracker.h"
+
+#ifdef GUI_TRACK_ALLOCATIONS
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <SDL2/SDL.h>
+
+static const size_t PhaseCount = static_cast<size_t>(FramePhase::Count);
+static const char* const phaseNames[PhaseCount] = { "idle", "events", "snap", "update", "render" };
+
+// -1 on threads that never entered a phase, whose allocations are ignored.
+static thread_local int currentPhase = -1;
+static std::atomic<size_t> phaseCounts[PhaseCount];
+static std::atomic<size_t> phaseBytes[PhaseCount];
+
+static std::atomic<bool> steadyState{ false };
+static std::atomic<bool> assertSteadyState{ false };
+static std::atomic<size_t> frameViolations{ 0 };
+static std::atomic<size_t> totalViolations{ 0 };
+
+// Only touched by the thread that calls endFrame.
+static PhaseAllocations frameAllocations[PhaseCount];
+static PhaseAllocations publishedTotals[PhaseCount];
+static size_t frameNumber = 0;
+static std::FILE* logFile = nullptr;
+
+// Set while the tracker itself reports, so its own allocations are not counted.
+static thread_local bool reporting = false;
+
+static SDL_malloc_func sdlMalloc;
+static SDL_calloc_func sdlCalloc;
+static SDL_realloc_func sdlRealloc;
+static SDL_free_func sdlFree;
+
+void AllocationTracker::recordAllocation(size_t bytes)
+{
+	int phase = currentPhase;
+	if (reporting || phase < 0)
+	{
+		return;
+	}
+
+	phaseCounts[phase].fetch_add(1, std::memory_order_relaxed);
+	phaseBytes[phase].fetch_add(bytes, std::memory_order_relaxed);
+
+	if (steadyState.load(std::memory_order_relaxed))
+	{
+		totalViolations.fetch_add(1, std::memory_order_relaxed);
+		if (frameViolations.fetch_add(1, std::memory_order_relaxed) == 0 &&
+			assertSteadyState.load(std::memory_order_relaxed))
+		{
+			reporting = true;
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+				"Heap allocation of %u bytes during a steady-state drag frame (phase: %s)",
+				static_cast<unsigned int>(bytes), phaseNames[phase]);
+			SDL_assert(!"heap allocation during a steady-state drag frame");
+			reporting = false;
+		}
+	}
+}
+
+static void* SDLCALL countingMalloc(size_t size)
+{
+	AllocationTracker::recordAllocation(size);
+	return sdlMalloc(size);
+}
+
+static void* SDLCALL countingCalloc(size_t count, size_t size)
+{
+	AllocationTracker::recordAllocation(count * size);
+	return sdlCalloc(count, size);
+}
+
+static void* SDLCALL countingRealloc(void* pointer, size_t size)
+{
+	AllocationTracker::recordAllocation(size);
+	return sdlRealloc(pointer, size);
+}
+
+void AllocationTracker::install()
+{
+	SDL_GetMemoryFunctions(&sdlMalloc, &sdlCalloc, &sdlRealloc, &sdlFree);
+	SDL_SetMemoryFunctions(countingMalloc, countingCalloc, countingRealloc, sdlFree);
+}
+
+bool AllocationTracker::openLog(const char* path)
+{
+	reporting = true;
+	if (logFile)
+	{
+		std::fclose(logFile);
+	}
+	logFile = std::fopen(path, "w");
+	reporting = false;
+	return logFile != nullptr;
+}
+
+void AllocationTracker::setAssertSteadyState(bool enabled)
+{
+	assertSteadyState.store(enabled, std::memory_order_relaxed);
+}
+
+void AllocationTracker::setSteadyState(bool steady)
+{
+	steadyState.store(steady, std::memory_order_relaxed);
+}
+
+FramePhase AllocationTracker::enterPhase(FramePhase phase)
+{
+	int previous = currentPhase < 0 ? static_cast<int>(FramePhase::Idle) : currentPhase;
+	currentPhase = static_cast<int>(phase);
+	return static_cast<FramePhase>(previous);
+}
+
+void AllocationTracker::endFrame()
+{
+	for (size_t phase = 0; phase < PhaseCount; ++phase)
+	{
+		PhaseAllocations totals = {
+			phaseCounts[phase].load(std::memory_order_relaxed),
+			phaseBytes[phase].load(std::memory_order_relaxed)
+		};
+		frameAllocations[phase] = { totals.count - publishedTotals[phase].count, totals.bytes - publishedTotals[phase].bytes };
+		publishedTotals[phase] = totals;
+	}
+
+	size_t violations = frameViolations.exchange(0, std::memory_order_relaxed);
+
+	if (logFile)
+	{
+		reporting = true;
+		std::fprintf(logFile, "{\"frame\":%zu,\"steady\":%s,\"violations\":%zu,\"count\":{",
+			frameNumber, steadyState.load(std::memory_order_relaxed) ? "true" : "false", violations);
+		for (size_t phase = 0; phase < PhaseCount; ++phase)
+		{
+			std::fprintf(logFile, "%s\"%s\":%zu", phase ? "," : "", phaseNames[phase], frameAllocations[phase].count);
+		}
+		std::fprintf(logFile, "},\"bytes\":{");
+		for (size_t phase = 0; phase < PhaseCount; ++phase)
+		{
+			std::fprintf(logFile, "%s\"%s\":%zu", phase ? "," : "", phaseNames[phase], frameAllocations[phase].bytes);
+		}
+		std::fprintf(logFile, "}}\n");
+		reporting = false;
+	}
+
+	++frameNumber;
+}
+
+PhaseAllocations AllocationTracker::getFrameAllocations(FramePhase phase)
+{
+	return frameAllocations[static_cast<size_t>(phase)];
+}
+
+size_t AllocationTracker::getTotalAllocations()
+{
+	size_t total = 0;
+	for (size_t phase = 0; phase < PhaseCount; ++phase)
+	{
+		total += phaseCounts[phase].load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+size_t AllocationTracker::getSteadyStateViolations()
+{
+	return totalViolations.load(std::memory_order_relaxed);
+}
+
+// Global allocation functions. Every form funnels into these two helpers.
+
+static void* trackedAllocate(size_t size)
+{
+	AllocationTracker::recordAllocation(size);
+	return std::malloc(size ? size : 1);
+}
+
+static void* trackedAllocateAligned(size_t size, std::align_val_t alignment)
+{
+	AllocationTracker::recordAllocation(size);
+	size_t align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+	return _aligned_malloc(size ? size : 1, align);
+#else
+	// aligned_alloc wants a multiple of the alignment.
+	return std::aligned_alloc(align, ((size ? size : 1) + align - 1) / align * align);
+#endif
+}
+
+static void trackedFreeAligned(void* pointer)
+{
+#ifdef _WIN32
+	_aligned_free(pointer);
+#else
+	std::free(pointer);
+#endif
+}
+
+void* operator new(size_t size)
+{
+	if (void* pointer = trackedAllocate(size))
+	{
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return trackedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return trackedAllocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (void* pointer = trackedAllocateAligned(size, alignment))
+	{
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { trackedFreeAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { trackedFreeAligned(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { trackedFreeAligned(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { trackedFreeAligned(pointer); }
+
+#endif
\ No newline at end of file
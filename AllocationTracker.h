@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+
+enum class FramePhase { Idle, Events, Snap, Update, Render, Count };
+
+struct PhaseAllocations
+{
+	size_t count = 0;
+	size_t bytes = 0;
+};
+
+#ifdef GUI_TRACK_ALLOCATIONS
+
+// Counts every heap allocation made through operator new or SDL's allocator
+// and attributes it to the frame phase GuiController is in at the time. The
+// phase is per thread and only threads that have entered one are counted, so
+// background threads such as the autosave writer and job system workers do
+// not show up in the controller's frames. Only compiled in when
+// GUI_TRACK_ALLOCATIONS is defined; otherwise every call below is an empty
+// inline function.
+class AllocationTracker
+{
+public:
+	static constexpr bool Enabled = true;
+
+	// Routes SDL_malloc and friends through the tracker. Call before SDL_Init.
+	static void install();
+
+	// Appends one JSON line per frame with allocation counts and bytes per phase.
+	static bool openLog(const char* path);
+
+	// When enabled, the first allocation in a steady-state frame logs an error
+	// and raises SDL_assert.
+	static void setAssertSteadyState(bool enabled);
+	static void setSteadyState(bool steady);
+
+	// Makes the calling thread a tracked one if it was not already; until the
+	// first call it counts as Idle.
+	static FramePhase enterPhase(FramePhase phase);
+
+	// Closes the current frame: publishes its counts and writes the log line.
+	static void endFrame();
+
+	static PhaseAllocations getFrameAllocations(FramePhase phase);
+	static size_t getTotalAllocations();
+	static size_t getSteadyStateViolations();
+
+	static void recordAllocation(size_t bytes);
+};
+
+#else
+
+class AllocationTracker
+{
+public:
+	static constexpr bool Enabled = false;
+
+	static void install() {}
+	static bool openLog(const char*) { return false; }
+	static void setAssertSteadyState(bool) {}
+	static void setSteadyState(bool) {}
+	static FramePhase enterPhase(FramePhase) { return FramePhase::Idle; }
+	static void endFrame() {}
+	static PhaseAllocations getFrameAllocations(FramePhase) { return {}; }
+	static size_t getTotalAllocations() { return 0; }
+	static size_t getSteadyStateViolations() { return 0; }
+};
+
+#endif
+
+// Attributes allocations to a phase for the lifetime of the scope.
+class AllocationPhaseScope
+{
+public:
+	explicit AllocationPhaseScope(FramePhase phase) : _previous(AllocationTracker::enterPhase(phase)) {}
+	~AllocationPhaseScope() { AllocationTracker::enterPhase(_previous); }
+
+	AllocationPhaseScope(const AllocationPhaseScope&) = delete;
+	AllocationPhaseScope& operator=(const AllocationPhaseScope&) = delete;
+
+private:
+	FramePhase _previous;
+};
\ No newline at end of file
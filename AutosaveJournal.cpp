@@ -0,0 +1,391 @@
+#include "AutosaveJournal.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+AutosaveJournal::AutosaveJournal(const std::string& basePath)
+	: _journalPath(basePath + ".journal"), _snapshotPath(basePath + ".snapshot"), _tempPath(_snapshotPath + ".tmp")
+{
+	// Snapshots only ever replace each other whole, but one written by an
+	// older build may have been deleted before its replacement was moved in.
+	if (!replayFile(_snapshotPath, _scene))
+	{
+		replayFile(_tempPath, _scene);
+	}
+	replayFile(_journalPath, _scene);
+	_restored = _scene;
+
+	// Start every session from a compact snapshot and an empty journal.
+	if (!compact())
+	{
+		std::cerr << "Could not open autosave journal " << _journalPath << "; edits will not be saved" << std::endl;
+	}
+
+	_writer = std::thread(&AutosaveJournal::writerLoop, this);
+}
+
+AutosaveJournal::~AutosaveJournal()
+{
+	// Shutdown is the one place the UI thread waits for the writer.
+	while (!flushPending())
+	{
+		requestFlush();
+		std::this_thread::yield();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_wakeMutex);
+		_running.store(false, std::memory_order_release);
+	}
+	_wake.notify_one();
+	_writer.join();
+
+	// A clean shutdown leaves only the snapshot to replay.
+	compact();
+
+	if (_journalFile)
+	{
+		std::fclose(_journalFile);
+	}
+}
+
+void AutosaveJournal::recordAdd(Uint32 id, const SDL_Rect& rect, const SDL_Color& color)
+{
+	push({ JournalRecord::Type::Add, id, rect, color });
+}
+
+void AutosaveJournal::recordMove(Uint32 id, const SDL_Rect& rect)
+{
+	push({ JournalRecord::Type::Move, id, rect, {} });
+}
+
+void AutosaveJournal::recordRecolor(Uint32 id, const SDL_Color& color)
+{
+	push({ JournalRecord::Type::Recolor, id, {}, color });
+}
+
+void AutosaveJournal::recordBatch(std::vector<JournalRecord> records)
+{
+	// The list goes ahead of its marker. Should the writer be that far
+	// behind, the records are queued one by one instead.
+	if (!_batches.tryPush(std::move(records)))
+	{
+		for (const JournalRecord& record : records)
+		{
+			push(record);
+		}
+		return;
+	}
+	push({ JournalRecord::Type::Batch, 0, {}, {} });
+}
+
+bool AutosaveJournal::flushPending()
+{
+	while (_pendingHead < _pending.size())
+	{
+		if (!_queue.tryPush(_pending[_pendingHead]))
+		{
+			return false;
+		}
+		++_pendingHead;
+	}
+
+	_pending.clear();
+	_pendingHead = 0;
+	_coalesceFloor = 0;
+	return true;
+}
+
+void AutosaveJournal::push(const JournalRecord& record)
+{
+	// Nothing may overtake a waiting record.
+	if (flushPending() && _queue.tryPush(record))
+	{
+		return;
+	}
+	defer(record);
+	requestFlush();
+}
+
+void AutosaveJournal::defer(const JournalRecord& record)
+{
+	_deferred.fetch_add(1, std::memory_order_relaxed);
+
+	if (record.type == JournalRecord::Type::Move)
+	{
+		// Moves are absolute, so only the latest one still waiting matters.
+		if (record.id < _pendingMoves.size())
+		{
+			size_t slot = _pendingMoves[record.id];
+			if (slot >= _pendingHead && slot >= _coalesceFloor && slot < _pending.size()
+				&& _pending[slot].type == JournalRecord::Type::Move && _pending[slot].id == record.id)
+			{
+				_pending[slot].rect = record.rect;
+				_coalesced.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+		else
+		{
+			_pendingMoves.resize(record.id + 1, SIZE_MAX);
+		}
+		_pendingMoves[record.id] = _pending.size();
+	}
+
+	_pending.push_back(record);
+	if (record.type == JournalRecord::Type::Add || record.type == JournalRecord::Type::Batch)
+	{
+		_coalesceFloor = _pending.size();
+	}
+}
+
+void AutosaveJournal::requestFlush()
+{
+	{
+		std::lock_guard<std::mutex> lock(_wakeMutex);
+		_flushRequested.store(true, std::memory_order_release);
+	}
+	_wake.notify_one();
+}
+
+void AutosaveJournal::writerLoop()
+{
+	while (true)
+	{
+		// Read the flag before draining so that everything pushed before
+		// shutdown is written by the last iteration.
+		bool running = _running.load(std::memory_order_acquire);
+		_flushRequested.store(false, std::memory_order_relaxed);
+
+		drain();
+
+		if (_recordsSinceSnapshot >= CompactionInterval)
+		{
+			compact();
+		}
+
+		if (!running)
+		{
+			break;
+		}
+
+		std::unique_lock<std::mutex> lock(_wakeMutex);
+		_wake.wait_for(lock, FlushInterval, [this]
+			{
+				return !_running.load(std::memory_order_acquire) || _flushRequested.load(std::memory_order_acquire);
+			});
+	}
+}
+
+void AutosaveJournal::drain()
+{
+	auto write = [this](const JournalRecord& record)
+		{
+			apply(_scene, record);
+			appendRecord(_buffer, record);
+			++_recordsSinceSnapshot;
+		};
+
+	JournalRecord record;
+	while (_queue.tryPop(record))
+	{
+		if (record.type != JournalRecord::Type::Batch)
+		{
+			write(record);
+			continue;
+		}
+
+		// The list was queued before its marker, so it is always there.
+		std::vector<JournalRecord> batch;
+		_batches.tryPop(batch);
+		for (const JournalRecord& batched : batch)
+		{
+			write(batched);
+		}
+	}
+
+	if (_buffer.empty())
+	{
+		return;
+	}
+
+	// One write per batch; records that are only partially written by a crash
+	// are rejected by parseRecord on replay.
+	if (_journalFile)
+	{
+		std::fwrite(_buffer.data(), 1, _buffer.size(), _journalFile);
+		std::fflush(_journalFile);
+	}
+	_buffer.clear();
+}
+
+bool AutosaveJournal::compact()
+{
+	std::FILE* file = std::fopen(_tempPath.c_str(), "wb");
+	if (!file)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Could not write autosave snapshot %s", _tempPath.c_str());
+		return false;
+	}
+
+	std::string contents;
+	for (size_t id = 0; id < _scene.size(); ++id)
+	{
+		appendRecord(contents, { JournalRecord::Type::Add, static_cast<Uint32>(id), _scene[id].rect, _scene[id].color });
+	}
+	bool written = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+	written = std::fclose(file) == 0 && written;
+
+	// The old snapshot stays in place until the new one atomically replaces
+	// it, and the journal is only cut once that has happened, so there is
+	// always a complete copy on disk.
+	if (!written || !replaceFile(_tempPath, _snapshotPath))
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Could not replace autosave snapshot %s", _snapshotPath.c_str());
+		return false;
+	}
+
+	// Records are absolute, so a crash before this truncation only replays
+	// some of them twice.
+	if (_journalFile)
+	{
+		std::fclose(_journalFile);
+	}
+	_journalFile = std::fopen(_journalPath.c_str(), "wb");
+	_recordsSinceSnapshot = 0;
+	return _journalFile != nullptr;
+}
+
+void AutosaveJournal::apply(std::vector<SceneItem>& scene, const JournalRecord& record)
+{
+	if (record.type == JournalRecord::Type::Add)
+	{
+		if (record.id == scene.size())
+		{
+			scene.push_back({ record.rect, record.color });
+		}
+		else if (record.id < scene.size())
+		{
+			scene[record.id] = { record.rect, record.color };
+		}
+		return;
+	}
+
+	if (record.id >= scene.size())
+	{
+		return;
+	}
+
+	if (record.type == JournalRecord::Type::Move)
+	{
+		scene[record.id].rect = record.rect;
+	}
+	else if (record.type == JournalRecord::Type::Recolor)
+	{
+		scene[record.id].color = record.color;
+	}
+}
+
+void AutosaveJournal::appendRecord(std::string& buffer, const JournalRecord& record)
+{
+	char line[96];
+	int length = 0;
+
+	switch (record.type)
+	{
+	case JournalRecord::Type::Add:
+		length = SDL_snprintf(line, sizeof(line), "A %u %d %d %d %d %u %u %u %u\n", record.id,
+			record.rect.x, record.rect.y, record.rect.w, record.rect.h,
+			record.color.r, record.color.g, record.color.b, record.color.a);
+		break;
+	case JournalRecord::Type::Move:
+		length = SDL_snprintf(line, sizeof(line), "M %u %d %d %d %d\n", record.id,
+			record.rect.x, record.rect.y, record.rect.w, record.rect.h);
+		break;
+	case JournalRecord::Type::Recolor:
+		length = SDL_snprintf(line, sizeof(line), "C %u %u %u %u %u\n", record.id,
+			record.color.r, record.color.g, record.color.b, record.color.a);
+		break;
+	case JournalRecord::Type::Batch:
+		return;
+	}
+
+	buffer.append(line, length);
+}
+
+bool AutosaveJournal::parseRecord(const char* line, JournalRecord& record)
+{
+	size_t length = std::strlen(line);
+	if (length == 0 || line[length - 1] != '\n')
+	{
+		// Torn write at the end of the file.
+		return false;
+	}
+
+	unsigned int r = 0, g = 0, b = 0, a = 0;
+	switch (line[0])
+	{
+	case 'A':
+		record.type = JournalRecord::Type::Add;
+		if (SDL_sscanf(line, "A %u %d %d %d %d %u %u %u %u", &record.id,
+			&record.rect.x, &record.rect.y, &record.rect.w, &record.rect.h, &r, &g, &b, &a) != 9)
+		{
+			return false;
+		}
+		break;
+	case 'M':
+		record.type = JournalRecord::Type::Move;
+		return SDL_sscanf(line, "M %u %d %d %d %d", &record.id,
+			&record.rect.x, &record.rect.y, &record.rect.w, &record.rect.h) == 5;
+	case 'C':
+		record.type = JournalRecord::Type::Recolor;
+		if (SDL_sscanf(line, "C %u %u %u %u %u", &record.id, &r, &g, &b, &a) != 5)
+		{
+			return false;
+		}
+		break;
+	default:
+		return false;
+	}
+
+	record.color = { static_cast<Uint8>(r), static_cast<Uint8>(g), static_cast<Uint8>(b), static_cast<Uint8>(a) };
+	return true;
+}
+
+bool AutosaveJournal::replaceFile(const std::string& from, const std::string& to)
+{
+#ifdef _WIN32
+	return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	// rename() replaces the target atomically on POSIX.
+	return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+bool AutosaveJournal::replayFile(const std::string& path, std::vector<SceneItem>& scene)
+{
+	std::FILE* file = std::fopen(path.c_str(), "rb");
+	if (!file)
+	{
+		return false;
+	}
+
+	char line[128];
+	JournalRecord record;
+	while (std::fgets(line, sizeof(line), file))
+	{
+		if (parseRecord(line, record))
+		{
+			apply(scene, record);
+		}
+	}
+
+	std::fclose(file);
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "SpscQueue.h"
+
+struct JournalRecord
+{
+	// Batch stands in for a list of records handed over by recordBatch().
+	enum class Type : Uint8 { Add, Move, Recolor, Batch };
+
+	Type type;
+	Uint32 id;
+	SDL_Rect rect;
+	SDL_Color color;
+};
+
+struct SceneItem
+{
+	SDL_Rect rect;
+	SDL_Color color;
+};
+
+// Append-only log of component mutations. The UI thread only enqueues records;
+// a background thread appends them to <basePath>.journal in batches and
+// periodically compacts everything into <basePath>.snapshot.
+class AutosaveJournal
+{
+public:
+	// Replays the previous session (snapshot, then journal on top of it),
+	// compacts it into a fresh snapshot and starts the writer thread.
+	explicit AutosaveJournal(const std::string& basePath);
+	~AutosaveJournal();
+
+	AutosaveJournal(const AutosaveJournal&) = delete;
+	AutosaveJournal& operator=(const AutosaveJournal&) = delete;
+
+	// Scene recovered at construction, indexed by component id.
+	const std::vector<SceneItem>& getRestoredScene() const { return _restored; }
+
+	// UI thread only. Each call is a single bounded enqueue that never waits.
+	// Records build on the ones before them (an Add's id is its position in
+	// the scene), so none is dropped: if the writer falls more than the queue
+	// capacity behind, records wait on the UI thread until there is room, and
+	// a waiting move is overwritten by the next move of the same component.
+	void recordAdd(Uint32 id, const SDL_Rect& rect, const SDL_Color& color);
+	void recordMove(Uint32 id, const SDL_Rect& rect);
+	void recordRecolor(Uint32 id, const SDL_Color& color);
+
+	// Any number of records, e.g. every member of a dragged selection, for
+	// the cost of one queue entry.
+	void recordBatch(std::vector<JournalRecord> records);
+
+	// UI thread only, once per frame. Hands waiting records to the writer;
+	// returns false while some are still waiting.
+	bool flushPending();
+
+	size_t getDeferredRecords() const { return _deferred.load(std::memory_order_relaxed); }
+	size_t getCoalescedRecords() const { return _coalesced.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr size_t QueueCapacity = 8192;
+	static constexpr size_t BatchCapacity = 64;
+	static constexpr size_t CompactionInterval = 4096;
+	static constexpr std::chrono::milliseconds FlushInterval{ 50 };
+
+	void push(const JournalRecord& record);
+	void defer(const JournalRecord& record);
+	void requestFlush();
+	void writerLoop();
+	void drain();
+	bool compact();
+
+	static void apply(std::vector<SceneItem>& scene, const JournalRecord& record);
+	static void appendRecord(std::string& buffer, const JournalRecord& record);
+	static bool parseRecord(const char* line, JournalRecord& record);
+	static bool replayFile(const std::string& path, std::vector<SceneItem>& scene);
+	static bool replaceFile(const std::string& from, const std::string& to);
+
+	std::string _journalPath;
+	std::string _snapshotPath;
+	std::string _tempPath;
+
+	std::vector<SceneItem> _restored;
+
+	// Owned by the writer thread once it has started.
+	std::vector<SceneItem> _scene;
+	std::string _buffer;
+	std::FILE* _journalFile = nullptr;
+	size_t _recordsSinceSnapshot = 0;
+
+	SpscQueue<JournalRecord> _queue{ QueueCapacity };
+
+	// recordBatch() lists, taken by the writer as it reaches their markers.
+	SpscQueue<std::vector<JournalRecord>> _batches{ BatchCapacity };
+
+	// UI thread only: records that did not fit in the queue, in order from
+	// _pendingHead, and where each component's last waiting move is. Moves
+	// before _coalesceFloor are behind an Add or a batch and stay as they are.
+	std::vector<JournalRecord> _pending;
+	size_t _pendingHead = 0;
+	size_t _coalesceFloor = 0;
+	std::vector<size_t> _pendingMoves;
+	std::atomic<size_t> _deferred{ 0 };
+	std::atomic<size_t> _coalesced{ 0 };
+
+	std::atomic<bool> _running{ true };
+	std::atomic<bool> _flushRequested{ false };
+	std::mutex _wakeMutex;
+	std::condition_variable _wake;
+	std::thread _writer;
+};
\ No newline at end of file
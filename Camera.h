@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <SDL2/SDL.h>
+
+// Maps world coordinates, in which component rects live, to screen pixels.
+// (x, y) is the world point at the top-left corner of the viewport.
+struct Camera
+{
+	static constexpr double MinZoom = 1.0 / 1024.0;
+	static constexpr double MaxZoom = 64.0;
+
+	double x = 0.0;
+	double y = 0.0;
+	double zoom = 1.0;
+
+	// Edges are rounded independently, so rects that touch in the world still
+	// touch on screen. Anything with an area stays at least a pixel wide.
+	SDL_Rect toScreen(const SDL_Rect& rect) const
+	{
+		int left = static_cast<int>(std::floor((rect.x - x) * zoom));
+		int top = static_cast<int>(std::floor((rect.y - y) * zoom));
+		int right = static_cast<int>(std::floor((rect.x + rect.w - x) * zoom));
+		int bottom = static_cast<int>(std::floor((rect.y + rect.h - y) * zoom));
+		return { left, top, std::max(right - left, rect.w > 0 ? 1 : 0), std::max(bottom - top, rect.h > 0 ? 1 : 0) };
+	}
+
+	SDL_Point toWorld(int screenX, int screenY) const
+	{
+		return { static_cast<int>(std::floor(x + screenX / zoom)), static_cast<int>(std::floor(y + screenY / zoom)) };
+	}
+
+	// World area covered by a viewport of the given size, rounded outwards.
+	SDL_Rect getVisibleRect(int viewportWidth, int viewportHeight) const
+	{
+		int left = static_cast<int>(std::floor(x));
+		int top = static_cast<int>(std::floor(y));
+		int right = static_cast<int>(std::ceil(x + viewportWidth / zoom));
+		int bottom = static_cast<int>(std::ceil(y + viewportHeight / zoom));
+		return { left, top, right - left, bottom - top };
+	}
+
+	void pan(double screenDeltaX, double screenDeltaY)
+	{
+		x -= screenDeltaX / zoom;
+		y -= screenDeltaY / zoom;
+	}
+
+	// Zooms by factor while keeping the world point under the given screen
+	// point where it is.
+	void zoomAt(int screenX, int screenY, double factor)
+	{
+		double worldX = x + screenX / zoom;
+		double worldY = y + screenY / zoom;
+		zoom = std::clamp(zoom * factor, MinZoom, MaxZoom);
+		x = worldX - screenX / zoom;
+		y = worldY - screenY / zoom;
+	}
+};
\ No newline at end of file
@@ -1,19 +1,22 @@
 #pragma once
 
 #include "GuiComponent.h"
+#include "Metrics.h"
 
 class DraggableRectangle : public GuiComponent
 {
 public:
 	DraggableRectangle(SDL_Renderer* renderer, const SDL_Rect& rect, const SDL_Color& color)
-		: GuiComponent(rect), _renderer(renderer), _color(color) {}
+		: GuiComponent(rect, color), _renderer(renderer) {}
 
 	bool handleEvent(const SDL_Event& event) override
 	{
+		// Use the coordinates carried by the event rather than the current
+		// mouse state, which may be ahead when events are handled late.
 		if (event.type == SDL_MOUSEBUTTONDOWN)
 		{
-			int x, y;
-			SDL_GetMouseState(&x, &y);
+			int x = event.button.x;
+			int y = event.button.y;
 
 			SDL_Point mousePoint = { x, y };
 			if (SDL_PointInRect(&mousePoint, &getRect()))
@@ -31,8 +34,8 @@ public:
 		}
 		else if (event.type == SDL_MOUSEMOTION && _dragging)
 		{
-			int x, y;
-			SDL_GetMouseState(&x, &y);
+			int x = event.motion.x;
+			int y = event.motion.y;
 
 			getRect().x = x - _dragOffsetX;
 			getRect().y = y - _dragOffsetY;
@@ -43,10 +46,50 @@ public:
 		return false;
 	}
 
-	void render() override
+	void render(const Camera& camera) override
 	{
-		SDL_SetRenderDrawColor(_renderer, _color.r, _color.g, _color.b, _color.a);
-		SDL_RenderFillRect(_renderer, &getRect());
+		SDL_Color color = getDisplayColor();
+		SDL_Rect screenRect = camera.toScreen(getRect());
+		SDL_SetRenderDrawColor(_renderer, color.r, color.g, color.b, color.a);
+		SDL_RenderFillRect(_renderer, &screenRect);
+		Metrics::add(Metric::DrawCalls);
+
+		if (_selected)
+		{
+			SDL_SetRenderDrawColor(_renderer, SelectedOutline.r, SelectedOutline.g, SelectedOutline.b, SelectedOutline.a);
+			SDL_RenderDrawRect(_renderer, &screenRect);
+			Metrics::add(Metric::DrawCalls);
+		}
+	}
+
+	void appendToSnapshot(RenderSnapshot& snapshot, const Camera& camera) const override
+	{
+		SDL_Rect screenRect = camera.toScreen(getRect());
+		snapshot.items.push_back({ screenRect, getDisplayColor() });
+		if (_selected)
+		{
+			appendOutline(snapshot, screenRect, SelectedOutline);
+		}
+	}
+
+	void onHoverEnter() override
+	{
+		_hovered = true;
+	}
+
+	void onHoverLeave() override
+	{
+		_hovered = false;
+	}
+
+	void onSelected() override
+	{
+		_selected = true;
+	}
+
+	void onDeselected() override
+	{
+		_selected = false;
 	}
 
 	bool isDragging() const override
@@ -54,15 +97,48 @@ public:
 		return _dragging;
 	}
 
+	bool isUpdateThreadSafe() const override
+	{
+		return true;
+	}
+
+	bool hasUpdate() const override
+	{
+		return false;
+	}
+
+	bool isOpaque() const override
+	{
+		return getColor().a == 255;
+	}
+
 	DraggableRectangle* clone() const override
 	{
-		return new DraggableRectangle(*this);
+		DraggableRectangle* copy = new DraggableRectangle(*this);
+		copy->_hovered = false;
+		copy->_selected = false;
+		return copy;
 	}
 
 private:
+	static constexpr SDL_Color SelectedOutline = { 40, 120, 220, 255 };
+
+	// Lightened a third of the way to white while hovered.
+	SDL_Color getDisplayColor() const
+	{
+		const SDL_Color& color = getColor();
+		if (!_hovered)
+		{
+			return color;
+		}
+		return { static_cast<Uint8>(color.r + (255 - color.r) / 3), static_cast<Uint8>(color.g + (255 - color.g) / 3),
+			static_cast<Uint8>(color.b + (255 - color.b) / 3), color.a };
+	}
+
 	SDL_Renderer* _renderer;
-	SDL_Color _color;
 	bool _dragging = false;
+	bool _hovered = false;
+	bool _selected = false;
 	int _dragOffsetX = 0;
 	int _dragOffsetY = 0;
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(size_t blockSize)
+	: _blockSize(blockSize)
+{
+	addBlock(_halves[0], _blockSize);
+	addBlock(_halves[1], _blockSize);
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment)
+{
+	Half& half = _halves[_current];
+
+	size_t start = alignedOffset(half.blocks.back(), half.offset, alignment);
+	if (start + bytes > half.blocks.back().size)
+	{
+		addBlock(half, bytes + alignment);
+		start = alignedOffset(half.blocks.back(), 0, alignment);
+	}
+
+	half.used += start + bytes - half.offset;
+	half.offset = start + bytes;
+	return half.blocks.back().data.get() + start;
+}
+
+void FrameArena::beginFrame()
+{
+	_current ^= 1;
+	Half& half = _halves[_current];
+
+	// A half that needed several blocks is replaced by a single block big
+	// enough for all of them, so the next frame like it fits without growing.
+	if (half.blocks.size() > 1)
+	{
+		size_t total = 0;
+		for (const Block& block : half.blocks)
+		{
+			total += block.size;
+		}
+		half.blocks.clear();
+		addBlock(half, total);
+	}
+
+	half.offset = 0;
+	half.used = 0;
+}
+
+size_t FrameArena::getCapacity() const
+{
+	size_t capacity = 0;
+	for (const Block& block : _halves[_current].blocks)
+	{
+		capacity += block.size;
+	}
+	return capacity;
+}
+
+size_t FrameArena::alignedOffset(const Block& block, size_t offset, size_t alignment)
+{
+	uintptr_t address = reinterpret_cast<uintptr_t>(block.data.get()) + offset;
+	uintptr_t aligned = (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+	return offset + static_cast<size_t>(aligned - address);
+}
+
+void FrameArena::addBlock(Half& half, size_t minimumSize)
+{
+	Block block;
+	block.size = std::max(_blockSize, minimumSize);
+	block.data.reset(new unsigned char[block.size]);
+	half.blocks.push_back(std::move(block));
+	half.offset = 0;
+}
\ No newline at end of file
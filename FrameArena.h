@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for data that only lives for a frame or two. Memory is never
+// freed individually; beginFrame() releases a whole frame's worth at once.
+//
+// The arena is split into two halves used on alternate frames. Whatever was
+// allocated during a frame stays valid through the following one, so data
+// gathered while handling events can still be read after the next render
+// has started. Once a half has grown to fit a frame, later frames of the same
+// size make no further heap allocations.
+//
+// Not thread-safe; allocate from one thread only.
+class FrameArena
+{
+public:
+	explicit FrameArena(size_t blockSize = 64 * 1024);
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void* allocate(size_t bytes, size_t alignment);
+
+	// Switches to the other half and resets it, invalidating everything that
+	// was allocated before the previous call.
+	void beginFrame();
+
+	// Bytes handed out from the current half, including alignment padding.
+	size_t getBytesUsed() const { return _halves[_current].used; }
+	size_t getCapacity() const;
+
+private:
+	struct Block
+	{
+		std::unique_ptr<unsigned char[]> data;
+		size_t size = 0;
+	};
+
+	struct Half
+	{
+		std::vector<Block> blocks;
+		size_t offset = 0; // Into the last block.
+		size_t used = 0;
+	};
+
+	static size_t alignedOffset(const Block& block, size_t offset, size_t alignment);
+	void addBlock(Half& half, size_t minimumSize);
+
+	size_t _blockSize;
+	Half _halves[2];
+	size_t _current = 0;
+};
+
+// Lets standard containers allocate from a FrameArena. deallocate is a no-op,
+// so a container that outgrows its storage leaves the old buffer in the arena
+// until the half is reset; reserve up front where the size is known.
+template <typename T>
+class ArenaAllocator
+{
+public:
+	using value_type = T;
+
+	ArenaAllocator(FrameArena& arena) noexcept : _arena(&arena) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) noexcept : _arena(other.getArena()) {}
+
+	T* allocate(size_t count)
+	{
+		return static_cast<T*>(_arena->allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T*, size_t) noexcept {}
+
+	FrameArena* getArena() const { return _arena; }
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U>& other) const { return _arena == other.getArena(); }
+
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const { return _arena != other.getArena(); }
+
+private:
+	FrameArena* _arena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
\ No newline at end of file
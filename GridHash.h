@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <SDL2/SDL.h>
+
+// Sparse 2D grid: cells are created on first use and stored densely, with an
+// open-addressing table (linear probing, at most half full) from cell
+// coordinates to cell indices. Cells are never removed, so indices stay valid.
+//
+// Cell needs int x and y members and a default constructor.
+template <typename Cell>
+class GridHash
+{
+public:
+	static constexpr Uint32 NoCell = UINT32_MAX;
+
+	Uint32 find(int x, int y) const
+	{
+		if (_buckets.empty())
+		{
+			return NoCell;
+		}
+
+		size_t mask = _buckets.size() - 1;
+		for (size_t bucket = bucketFor(x, y, _buckets.size());; bucket = (bucket + 1) & mask)
+		{
+			Uint32 cell = _buckets[bucket];
+			if (cell == NoCell || (_cells[cell].x == x && _cells[cell].y == y))
+			{
+				return cell;
+			}
+		}
+	}
+
+	Uint32 findOrAdd(int x, int y)
+	{
+		Uint32 cell = find(x, y);
+		if (cell != NoCell)
+		{
+			return cell;
+		}
+
+		if ((_cells.size() + 1) * 2 > _buckets.size())
+		{
+			rehash(std::max<size_t>(256, _buckets.size() * 2));
+		}
+
+		cell = static_cast<Uint32>(_cells.size());
+		_cells.emplace_back();
+		_cells.back().x = x;
+		_cells.back().y = y;
+		insertBucket(cell);
+		return cell;
+	}
+
+	Cell& operator[](Uint32 cell) { return _cells[cell]; }
+	const Cell& operator[](Uint32 cell) const { return _cells[cell]; }
+
+	const std::vector<Cell>& getCells() const { return _cells; }
+
+private:
+	static size_t bucketFor(int x, int y, size_t bucketCount)
+	{
+		Uint64 key = (static_cast<Uint64>(static_cast<Uint32>(x)) << 32) | static_cast<Uint32>(y);
+		return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & (bucketCount - 1);
+	}
+
+	void insertBucket(Uint32 cell)
+	{
+		size_t mask = _buckets.size() - 1;
+		size_t bucket = bucketFor(_cells[cell].x, _cells[cell].y, _buckets.size());
+		while (_buckets[bucket] != NoCell)
+		{
+			bucket = (bucket + 1) & mask;
+		}
+		_buckets[bucket] = cell;
+	}
+
+	void rehash(size_t bucketCount)
+	{
+		_cells.reserve(bucketCount / 2);
+		_buckets.assign(bucketCount, NoCell);
+		for (Uint32 cell = 0; cell < _cells.size(); ++cell)
+		{
+			insertBucket(cell);
+		}
+	}
+
+	std::vector<Cell> _cells;
+	std::vector<Uint32> _buckets;
+};
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "GridLayer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Metrics.h"
+
+GridLayer::~GridLayer()
+{
+	destroyStrips();
+}
+
+void GridLayer::setGrid(int spacing, int subdivisions)
+{
+	_subdivisions = std::clamp(subdivisions, 1, std::max(spacing, 1));
+	_step = std::max(spacing, 0) / _subdivisions;
+	_spacing = _step * _subdivisions;
+	_stripZoom = 0.0;
+}
+
+int GridLayer::getShownStep(double zoom) const
+{
+	if (_spacing == 0 || _spacing * zoom < MinLinePixels)
+	{
+		return 0;
+	}
+	return _step * zoom < MinLinePixels ? _spacing : _step;
+}
+
+template <typename Callback>
+void GridLayer::forEachLine(const Camera& camera, int viewportWidth, int viewportHeight, int shownStep, Callback&& callback) const
+{
+	for (bool vertical : { true, false })
+	{
+		double origin = vertical ? camera.x : camera.y;
+		int extent = vertical ? viewportWidth : viewportHeight;
+		for (long long line = static_cast<long long>(std::ceil(origin / shownStep)); ; ++line)
+		{
+			int position = static_cast<int>(std::floor((line * shownStep - origin) * camera.zoom));
+			if (position >= extent)
+			{
+				break;
+			}
+			callback(vertical, position, isMajor(line, shownStep));
+		}
+	}
+}
+
+void GridLayer::destroyStrips()
+{
+	if (_columns)
+	{
+		SDL_DestroyTexture(_columns);
+		_columns = nullptr;
+	}
+	if (_rows)
+	{
+		SDL_DestroyTexture(_rows);
+		_rows = nullptr;
+	}
+	_stripPixels = 0;
+}
+
+bool GridLayer::updateStrips(double zoom)
+{
+	if (_columns && _rows && _stripZoom == zoom)
+	{
+		return true;
+	}
+
+	int shownStep = getShownStep(zoom);
+	int cells = std::max(1, static_cast<int>(std::ceil(MinStripPixels / (_spacing * zoom))));
+	int stripWorld = _spacing * cells;
+	int stripPixels = static_cast<int>(std::floor(stripWorld * zoom));
+	if (stripPixels > MaxStripPixels)
+	{
+		return false;
+	}
+
+	if (stripPixels != _stripPixels)
+	{
+		destroyStrips();
+		_columns = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, stripPixels, 1);
+		_rows = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, 1, stripPixels);
+		if (!_columns || !_rows)
+		{
+			destroyStrips();
+			return false;
+		}
+		SDL_SetTextureBlendMode(_columns, SDL_BLENDMODE_BLEND);
+		SDL_SetTextureBlendMode(_rows, SDL_BLENDMODE_BLEND);
+		_stripPixels = stripPixels;
+	}
+
+	void* columnPixels;
+	void* rowPixels;
+	int columnPitch;
+	int rowPitch;
+	if (SDL_LockTexture(_columns, nullptr, &columnPixels, &columnPitch) != 0)
+	{
+		return false;
+	}
+	if (SDL_LockTexture(_rows, nullptr, &rowPixels, &rowPitch) != 0)
+	{
+		SDL_UnlockTexture(_columns);
+		return false;
+	}
+
+	// Transparent between the lines, so the strips blend over the background.
+	auto argb = [](const SDL_Color& color) { return (Uint32(color.a) << 24) | (Uint32(color.r) << 16) | (Uint32(color.g) << 8) | color.b; };
+	Uint32* columns = static_cast<Uint32*>(columnPixels);
+	std::fill(columns, columns + stripPixels, 0u);
+	for (int i = 0; i < stripPixels; ++i)
+	{
+		*reinterpret_cast<Uint32*>(static_cast<Uint8*>(rowPixels) + i * rowPitch) = 0;
+	}
+	for (int line = 0; line < stripWorld / shownStep; ++line)
+	{
+		int position = static_cast<int>(std::floor(line * shownStep * zoom));
+		Uint32 color = argb(isMajor(line, shownStep) ? MajorColor : MinorColor);
+		columns[position] = color;
+		*reinterpret_cast<Uint32*>(static_cast<Uint8*>(rowPixels) + position * rowPitch) = color;
+	}
+
+	SDL_UnlockTexture(_columns);
+	SDL_UnlockTexture(_rows);
+	_stripZoom = zoom;
+	_stripWorld = stripWorld;
+	return true;
+}
+
+void GridLayer::render(const Camera& camera, int viewportWidth, int viewportHeight)
+{
+	int shownStep = getShownStep(camera.zoom);
+	if (shownStep == 0)
+	{
+		return;
+	}
+
+	if (!updateStrips(camera.zoom))
+	{
+		forEachLine(camera, viewportWidth, viewportHeight, shownStep, [&](bool vertical, int position, bool major)
+			{
+				const SDL_Color& color = major ? MajorColor : MinorColor;
+				SDL_SetRenderDrawColor(_renderer, color.r, color.g, color.b, color.a);
+				if (vertical)
+				{
+					SDL_RenderDrawLine(_renderer, position, 0, position, viewportHeight - 1);
+				}
+				else
+				{
+					SDL_RenderDrawLine(_renderer, 0, position, viewportWidth - 1, position);
+				}
+				Metrics::add(Metric::DrawCalls);
+			});
+		return;
+	}
+
+	// Strips are placed by their world position, so a strip a pixel longer or
+	// shorter on screen than in the texture is stretched to fit and the lines
+	// do not drift along the screen.
+	for (bool vertical : { true, false })
+	{
+		double origin = vertical ? camera.x : camera.y;
+		int extent = vertical ? viewportWidth : viewportHeight;
+		for (long long strip = static_cast<long long>(std::floor(origin / _stripWorld)); ; ++strip)
+		{
+			int start = static_cast<int>(std::floor((strip * _stripWorld - origin) * camera.zoom));
+			if (start >= extent)
+			{
+				break;
+			}
+			int end = static_cast<int>(std::floor(((strip + 1) * _stripWorld - origin) * camera.zoom));
+			SDL_Rect target = vertical ? SDL_Rect{ start, 0, end - start, viewportHeight } : SDL_Rect{ 0, start, viewportWidth, end - start };
+			SDL_RenderCopy(_renderer, vertical ? _columns : _rows, nullptr, &target);
+			Metrics::add(Metric::DrawCalls);
+		}
+	}
+}
+
+void GridLayer::appendToSnapshot(RenderSnapshot& snapshot, const Camera& camera, int viewportWidth, int viewportHeight) const
+{
+	int shownStep = getShownStep(camera.zoom);
+	if (shownStep == 0)
+	{
+		return;
+	}
+
+	forEachLine(camera, viewportWidth, viewportHeight, shownStep, [&](bool vertical, int position, bool major)
+		{
+			SDL_Rect line = vertical ? SDL_Rect{ position, 0, 1, viewportHeight } : SDL_Rect{ 0, position, viewportWidth, 1 };
+			snapshot.items.push_back({ line, major ? MajorColor : MinorColor });
+		});
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include "Camera.h"
+#include "RenderSnapshot.h"
+
+// Background grid with a line every step world units and a stronger one
+// every spacing, i.e. every subdivisions-th line.
+//
+// render() does not draw the lines one by one. Two cached strip textures,
+// one pixel thick, hold a run of vertical and of horizontal lines at the
+// current zoom; each is stretched across the screen and repeated, so a frame
+// costs a handful of copies however many lines are on screen. The strips are
+// only redrawn when the zoom or the grid changes.
+class GridLayer
+{
+public:
+	explicit GridLayer(SDL_Renderer* renderer) : _renderer(renderer) {}
+	~GridLayer();
+
+	GridLayer(const GridLayer&) = delete;
+	GridLayer& operator=(const GridLayer&) = delete;
+
+	// spacing 0 turns the grid off. It is rounded down to a multiple of
+	// subdivisions so the fine lines meet the strong ones.
+	void setGrid(int spacing, int subdivisions);
+	bool isEnabled() const { return _spacing > 0; }
+	int getSpacing() const { return _spacing; }
+	int getStep() const { return _step; }
+
+	void render(const Camera& camera, int viewportWidth, int viewportHeight);
+
+	// The same lines as one thin item each, for renderers without textures.
+	void appendToSnapshot(RenderSnapshot& snapshot, const Camera& camera, int viewportWidth, int viewportHeight) const;
+
+private:
+	// Lines closer together on screen than this are left out.
+	static constexpr int MinLinePixels = 4;
+	// A strip covers whole cells and at least this many pixels; lines further
+	// apart than MaxStripPixels are few enough to draw one by one.
+	static constexpr int MinStripPixels = 256;
+	static constexpr int MaxStripPixels = 4096;
+	static constexpr SDL_Color MajorColor = { 200, 200, 200, 255 };
+	static constexpr SDL_Color MinorColor = { 232, 232, 232, 255 };
+
+	// World distance between the lines drawn at this zoom, or 0 for none.
+	int getShownStep(double zoom) const;
+	bool isMajor(long long line, int shownStep) const { return line % (_spacing / shownStep) == 0; }
+	// Calls callback(vertical, screenPosition, major) for each line on screen.
+	template <typename Callback>
+	void forEachLine(const Camera& camera, int viewportWidth, int viewportHeight, int shownStep, Callback&& callback) const;
+	bool updateStrips(double zoom);
+	void destroyStrips();
+
+	SDL_Renderer* _renderer;
+	int _spacing = 0;
+	int _subdivisions = 1;
+	int _step = 0;
+
+	// Strips for _stripZoom: _stripWorld world units, _stripPixels long.
+	SDL_Texture* _columns = nullptr;
+	SDL_Texture* _rows = nullptr;
+	double _stripZoom = 0.0;
+	int _stripWorld = 0;
+	int _stripPixels = 0;
+};
\ No newline at end of file
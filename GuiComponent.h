@@ -2,24 +2,74 @@
 
 #include <SDL2/SDL.h>
 
+#include "Camera.h"
+#include "FrameArena.h"
+#include "RenderSnapshot.h"
+
 class GuiComponent
 {
 public:
 	virtual ~GuiComponent() = default;
-	GuiComponent(const SDL_Rect& rect) : _rect(rect) {}
+	GuiComponent(const SDL_Rect& rect, const SDL_Color& color = { 0, 0, 0, 255 }) : _rect(rect), _color(color) {}
 
 	virtual GuiComponent* clone() const = 0;
 	virtual bool handleEvent(const SDL_Event& event) { return false; }
 	virtual void update() {}
-	virtual void render() {}
+
+	// The rect is in world coordinates; camera maps it to the screen.
+	virtual void render(const Camera& /*camera*/) {}
+
+	// Describes what render() would draw, for renderers that do not call back
+	// into the component (e.g. on another thread).
+	virtual void appendToSnapshot(RenderSnapshot& snapshot, const Camera& camera) const
+	{
+		snapshot.items.push_back({ camera.toScreen(_rect), _color });
+	}
 
 	virtual bool containsPoint(int x, int y) const { return false; }
 
 	SDL_Rect& getRect() { return _rect; }
+	const SDL_Rect& getRect() const { return _rect; }
 	void setRect(const SDL_Rect& rect) { _rect = rect; }
 
+	const SDL_Color& getColor() const { return _color; }
+	void setColor(const SDL_Color& color) { _color = color; }
+
+	// Pointer events only reach components under the pointer and those that
+	// took the last button press, until the button is released and they are
+	// no longer dragging.
 	virtual bool isDragging() const { return false; }
 
+	// Called when the component becomes, or stops being, the topmost one
+	// under the pointer. Only the hovered component gets motion events, apart
+	// from those holding on to the pointer.
+	virtual void onHoverEnter() {}
+	virtual void onHoverLeave() {}
+
+	// Called when the component joins or leaves the controller's selection.
+	virtual void onSelected() {}
+	virtual void onDeselected() {}
+
+	// Return true if render() fills exactly the rect with no transparency, so
+	// whatever lies entirely underneath need not be drawn.
+	virtual bool isOpaque() const { return false; }
+
+	// Return false if update() does nothing, so the controller can skip it.
+	virtual bool hasUpdate() const { return true; }
+
+	// Return true if update() only touches this component's own state, so the
+	// controller may run it concurrently with other components' updates.
+	virtual bool isUpdateThreadSafe() const { return false; }
+
+	// Set by the controller that owns the component; scratch containers built
+	// during a frame can allocate from it instead of the heap.
+	void setFrameArena(FrameArena* arena) { _frameArena = arena; }
+
+protected:
+	FrameArena* getFrameArena() const { return _frameArena; }
+
 private:
 	SDL_Rect _rect;
+	SDL_Color _color;
+	FrameArena* _frameArena = nullptr;
 };
\ No newline at end of file
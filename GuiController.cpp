@@ -1,74 +1,1533 @@
 #include "GuiController.h"
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "Metrics.h"
 #include "Utility.h"
 
-void GuiController::handleEvent(const SDL_Event& event)
+GuiController::GuiController(SDL_Renderer* renderer)
+	: _renderer(renderer), _grid(renderer), _damage(_frameArena), _frameDamage(_frameArena), _jobs(JobSystem::defaultWorkerCount())
+{
+	if (SDL_GetRendererOutputSize(renderer, &_viewportWidth, &_viewportHeight) != 0)
+	{
+		_viewportWidth = 640;
+		_viewportHeight = 480;
+	}
+	_pointerCaptures.reserve(16);
+	_hoverNeighbors.reserve(1024);
+}
+
+static bool isPointerEvent(const SDL_Event& event)
+{
+	return event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP || event.type == SDL_MOUSEMOTION;
+}
+
+void GuiController::handleEvent(const SDL_Event& event)
+{
+	AllocationPhaseScope phase(FramePhase::Events);
+	Metrics::add(Metric::EventsDispatched);
+
+	if (event.type == SDL_MOUSEMOTION)
+	{
+		_pointer = { event.motion.x, event.motion.y };
+	}
+	else if (event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP)
+	{
+		_pointer = { event.button.x, event.button.y };
+	}
+
+	for (size_t index = _overlays.size(); index-- > 0;)
+	{
+		if (_overlays[index]->handleEvent(event))
+		{
+			Metrics::add(Metric::EventsConsumed);
+			return;
+		}
+	}
+
+	if (handleCameraEvent(event))
+	{
+		Metrics::add(Metric::EventsConsumed);
+		return;
+	}
+
+	if (event.type == SDL_MOUSEBUTTONUP)
+	{
+		_dragActive = false;
+		_guideCount = 0;
+		_heldSnaps[AlignmentIndex::Horizontal] = AxisSnap{};
+		_heldSnaps[AlignmentIndex::Vertical] = AxisSnap{};
+		_sweepTracked = false;
+	}
+
+	if (!isPointerEvent(event))
+	{
+		for (size_t index = _components.size(); index-- > 0;)
+		{
+			if (dispatch(index, event))
+			{
+				break;
+			}
+		}
+		return;
+	}
+
+	// Components work in world coordinates.
+	SDL_Event worldEvent = event;
+	SDL_Point point;
+	if (event.type == SDL_MOUSEMOTION)
+	{
+		point = _camera.toWorld(event.motion.x, event.motion.y);
+		worldEvent.motion.x = point.x;
+		worldEvent.motion.y = point.y;
+		worldEvent.motion.xrel = static_cast<Sint32>(event.motion.xrel / _camera.zoom);
+		worldEvent.motion.yrel = static_cast<Sint32>(event.motion.yrel / _camera.zoom);
+	}
+	else
+	{
+		point = _camera.toWorld(event.button.x, event.button.y);
+		worldEvent.button.x = point.x;
+		worldEvent.button.y = point.y;
+	}
+
+	if (_selecting || _groupDragging)
+	{
+		if (event.type == SDL_MOUSEMOTION && _selecting)
+		{
+			moveSelectionBand(point);
+		}
+		else if (event.type == SDL_MOUSEMOTION)
+		{
+			if (_pendingInputTimestamp == 0)
+			{
+				_pendingInputTimestamp = event.common.timestamp;
+			}
+			moveGroup(point);
+		}
+		else if (event.type == SDL_MOUSEBUTTONUP && event.button.button == SDL_BUTTON_LEFT)
+		{
+			if (_selecting)
+			{
+				endSelectionBand();
+			}
+			else
+			{
+				endGroupDrag();
+			}
+		}
+		Metrics::add(Metric::EventsConsumed);
+		return;
+	}
+
+	// Only the components under the pointer and those holding on to it can
+	// react, topmost first. Motion goes to the hovered component alone.
+	FrameVector<Uint32> targets(_frameArena);
+	if (event.type == SDL_MOUSEMOTION)
+	{
+		setHovered(_picking ? pick(event.motion.x, event.motion.y) : findHovered(point));
+		if (_hovered != IdBuffer::NoId)
+		{
+			targets.push_back(_hovered);
+		}
+	}
+	else if (_picking)
+	{
+		Uint32 picked = pick(event.button.x, event.button.y);
+		if (picked != IdBuffer::NoId)
+		{
+			targets.push_back(picked);
+		}
+	}
+	else
+	{
+		_index.query({ point.x, point.y, 1, 1 }, [&](Uint32 id) { targets.push_back(id); });
+	}
+
+	// Shift-click toggles the component under the pointer and Shift-drag
+	// bands even over components. Pressing a selected component drags the
+	// whole selection; pressing anything else deselects.
+	bool leftPress = event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT;
+	if (leftPress)
+	{
+		Uint32 topmost = targets.empty() ? IdBuffer::NoId : *std::max_element(targets.begin(), targets.end());
+		if (SDL_GetModState() & KMOD_SHIFT)
+		{
+			beginSelectionBand(point, topmost);
+			return;
+		}
+		if (topmost != IdBuffer::NoId && isSelected(topmost))
+		{
+			beginGroupDrag(point);
+			return;
+		}
+		clearSelection();
+	}
+
+	targets.insert(targets.end(), _pointerCaptures.begin(), _pointerCaptures.end());
+	std::sort(targets.begin(), targets.end(), std::greater<Uint32>());
+	targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+
+	bool consumed = false;
+	for (Uint32 id : targets)
+	{
+		if (dispatch(id, worldEvent))
+		{
+			if (event.type == SDL_MOUSEBUTTONDOWN &&
+				std::find(_pointerCaptures.begin(), _pointerCaptures.end(), id) == _pointerCaptures.end())
+			{
+				_pointerCaptures.push_back(id);
+			}
+			consumed = true;
+			break;
+		}
+	}
+
+	if (leftPress && !consumed)
+	{
+		beginSelectionBand(point, IdBuffer::NoId);
+	}
+
+	if (event.type == SDL_MOUSEBUTTONUP)
+	{
+		_pointerCaptures.erase(std::remove_if(_pointerCaptures.begin(), _pointerCaptures.end(),
+			[this](Uint32 id) { return !_components[id]->isDragging(); }), _pointerCaptures.end());
+	}
+}
+
+bool GuiController::handleCameraEvent(const SDL_Event& event)
+{
+	switch (event.type)
+	{
+	case SDL_WINDOWEVENT:
+		if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+		{
+			setViewportSize(event.window.data1, event.window.data2);
+		}
+		else if (event.window.event == SDL_WINDOWEVENT_LEAVE)
+		{
+			setHovered(IdBuffer::NoId);
+		}
+		return false;
+	case SDL_MOUSEWHEEL:
+	{
+		int steps = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -event.wheel.y : event.wheel.y;
+		_camera.zoomAt(event.wheel.mouseX, event.wheel.mouseY, std::pow(1.25, steps));
+		break;
+	}
+	case SDL_MOUSEBUTTONDOWN:
+		if (event.button.button != SDL_BUTTON_MIDDLE)
+		{
+			return false;
+		}
+		_panning = true;
+		return true;
+	case SDL_MOUSEBUTTONUP:
+		if (event.button.button != SDL_BUTTON_MIDDLE)
+		{
+			return false;
+		}
+		_panning = false;
+		return true;
+	case SDL_MOUSEMOTION:
+		if (!_panning)
+		{
+			return false;
+		}
+		_camera.pan(event.motion.xrel, event.motion.yrel);
+		break;
+	default:
+		return false;
+	}
+
+	invalidateView();
+	return true;
+}
+
+void GuiController::setCamera(const Camera& camera)
+{
+	_camera = camera;
+	invalidateView();
+}
+
+void GuiController::invalidateView()
+{
+	_viewChanged = true;
+	_idsValid = false;
+	_idDamage.clear();
+}
+
+void GuiController::setViewportSize(int width, int height)
+{
+	_viewportWidth = width;
+	_viewportHeight = height;
+	invalidateView();
+}
+
+bool GuiController::dispatch(size_t index, const SDL_Event& event)
+{
+	auto& guiComponent = _components[index];
+	SDL_Rect previousRect = guiComponent->getRect();
+	if (!guiComponent->handleEvent(event))
+	{
+		return false;
+	}
+
+	Metrics::add(Metric::EventsConsumed);
+	if (_pendingInputTimestamp == 0)
+	{
+		_pendingInputTimestamp = event.common.timestamp;
+	}
+
+	if (guiComponent->isDragging())
+	{
+		_dragActive = true;
+
+		// Snap to the closest other component along each axis.
+		AllocationPhaseScope snapPhase(FramePhase::Snap);
+		Uint64 snapStart = SDL_GetPerformanceCounter();
+		SDL_Rect moved = guiComponent->getRect();
+		SnapResult snap = snapDrag(previousRect, moved, index);
+		if (snap.x.isSet() || snap.y.isSet())
+		{
+			Metrics::add(Metric::SnapsApplied);
+		}
+		guiComponent->setRect(snap.apply(moved));
+		updateGuides(guiComponent->getRect(), snap);
+		_snapTicks += SDL_GetPerformanceCounter() - snapStart;
+	}
+
+	const SDL_Rect& rect = guiComponent->getRect();
+	if (!SDL_RectEquals(&rect, &previousRect))
+	{
+		addDamage(previousRect);
+		addDamage(rect);
+		_index.update(static_cast<Uint32>(index), rect);
+		_alignment.update(static_cast<Uint32>(index), rect);
+		_lod.update(static_cast<Uint32>(index), rect, guiComponent->getColor());
+		refreshSelection(static_cast<Uint32>(index));
+
+		if (_journal)
+		{
+			_journal->recordMove(static_cast<Uint32>(index), rect);
+		}
+	}
+
+	return true;
+}
+
+void GuiController::syncIndex(size_t index)
+{
+	Uint32 id = static_cast<Uint32>(index);
+	const SDL_Rect& indexed = _index.getRect(id);
+	const SDL_Rect& rect = _components[index]->getRect();
+	const SDL_Color& color = _components[index]->getColor();
+	const SDL_Color& lodColor = _lod.getColor(id);
+	bool moved = !SDL_RectEquals(&rect, &indexed);
+	if (moved || color.r != lodColor.r || color.g != lodColor.g || color.b != lodColor.b)
+	{
+		addDamage(indexed);
+		addDamage(rect);
+		_lod.update(id, rect, color);
+		if (moved)
+		{
+			_index.update(id, rect);
+			_alignment.update(id, rect);
+			refreshSelection(id);
+		}
+	}
+}
+
+SnapResult GuiController::snapDrag(const SDL_Rect& previous, SDL_Rect& rect, size_t dragged)
+{
+	if (dragged != _heldDragged)
+	{
+		_heldDragged = dragged;
+		_heldSnaps[AlignmentIndex::Horizontal] = AxisSnap{};
+		_heldSnaps[AlignmentIndex::Vertical] = AxisSnap{};
+		_sweepTracked = false;
+	}
+
+	// A sweep runs from where the pointer put the rect last time, not from
+	// where the rect was snapped to, or pulling away from an edge would
+	// sweep straight back over it.
+	SDL_Rect from = _sweepTracked ? _sweepFrom : previous;
+	_sweepFrom = rect;
+	_sweepTracked = true;
+
+	// An axis that holds keeps its snap even if something else has come
+	// closer, so the rect does not flicker between targets at the edge of
+	// the threshold. With both holding there is nothing to search for.
+	bool heldX = isSnapHeld(AlignmentIndex::Horizontal, rect);
+	bool heldY = isSnapHeld(AlignmentIndex::Vertical, rect);
+	SnapResult snap;
+	if (heldX && heldY)
+	{
+		Metrics::add(Metric::SnapsHeld);
+		snap.x = _heldSnaps[AlignmentIndex::Horizontal];
+		snap.y = _heldSnaps[AlignmentIndex::Vertical];
+		return snap;
+	}
+
+	// The other axis is searched with the held one already in place.
+	if (heldX)
+	{
+		rect.x = _heldSnaps[AlignmentIndex::Horizontal].position;
+	}
+	if (heldY)
+	{
+		rect.y = _heldSnaps[AlignmentIndex::Vertical].position;
+	}
+	snap = findSnap(rect, dragged);
+	if (_sweptSnapping && !heldX && !heldY && !snap.x.isSet() && !snap.y.isSet())
+	{
+		findSweptSnap(from, rect, dragged, snap);
+	}
+
+	for (int i = 0; i < AlignmentIndex::AxisCount; ++i)
+	{
+		auto axis = static_cast<AlignmentIndex::Axis>(i);
+		AxisSnap& axisSnap = axis == AlignmentIndex::Horizontal ? snap.x : snap.y;
+		if (axis == AlignmentIndex::Horizontal ? heldX : heldY)
+		{
+			axisSnap = _heldSnaps[axis];
+		}
+		else
+		{
+			_heldSnaps[axis] = axisSnap;
+			if (axisSnap.isSet() && axisSnap.target != GridTarget)
+			{
+				_heldTargets[axis] = _index.getRect(static_cast<Uint32>(axisSnap.target));
+			}
+		}
+	}
+	return snap;
+}
+
+bool GuiController::isSnapHeld(AlignmentIndex::Axis axis, const SDL_Rect& rect) const
+{
+	const AxisSnap& held = _heldSnaps[axis];
+	if (!held.isSet() || std::abs(AlignmentIndex::getCoordinate(rect, axis, AlignmentIndex::Start) - held.position) > _snapRelease)
+	{
+		return false;
+	}
+	return held.target == GridTarget ? _grid.isEnabled() :
+		SDL_RectEquals(&_heldTargets[axis], &_index.getRect(static_cast<Uint32>(held.target))) == SDL_TRUE;
+}
+
+int GuiController::getSnapAreas(const SDL_Rect& rect, SDL_Rect areas[4]) const
+{
+	int reach = _threshold + 1;
+	if (rect.w <= 4 * reach || rect.h <= 4 * reach)
+	{
+		// whichSideIsNear compares rect.y + rect.w against the other rect's
+		// vertical extent, so a match can lie up to |w - h| beyond the threshold.
+		int margin = _threshold + std::abs(rect.w - rect.h) + 1;
+		areas[0] = { rect.x - margin, rect.y - margin, rect.w + 2 * margin, rect.h + 2 * margin };
+		return 1;
+	}
+
+	// Only rects within the threshold of an edge can match, so the middle
+	// of a large rect, such as a dragged group's bounds, is left out. The
+	// side strips reach down to rect.y + rect.w for the reason above.
+	int sideTop = rect.y - reach;
+	int sideHeight = std::max(rect.h, rect.w) + 2 * reach;
+	areas[0] = { rect.x - reach, sideTop, 2 * reach, sideHeight };
+	areas[1] = { rect.x + rect.w - reach, sideTop, 2 * reach, sideHeight };
+	areas[2] = { rect.x - reach, rect.y - reach, rect.w + 2 * reach, 2 * reach };
+	areas[3] = { rect.x - reach, rect.y + rect.h - reach, rect.w + 2 * reach, 2 * reach };
+	return 4;
+}
+
+void GuiController::collectSnapCandidates(const SDL_Rect& rect, FrameVector<Uint32>& candidates) const
+{
+	SDL_Rect areas[4];
+	int areaCount = getSnapAreas(rect, areas);
+	for (int i = 0; i < areaCount; ++i)
+	{
+		_index.query(areas[i], [&](Uint32 id) { candidates.push_back(id); });
+	}
+	if (areaCount > 1)
+	{
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	}
+}
+
+SnapResult GuiController::findSnap(const SDL_Rect& rect, size_t dragged)
+{
+	FrameVector<Uint32> candidates(_frameArena);
+	collectSnapCandidates(rect, candidates);
+
+	SnapResult snap;
+	size_t count = candidates.size();
+	size_t chunkCount = _jobs.getThreadCount();
+	if (count < _parallelSnapThreshold || chunkCount == 1)
+	{
+		snap = findSnap(rect, dragged, candidates.data(), count);
+	}
+	else
+	{
+		// One contiguous chunk per thread, each with its own result, merged
+		// in chunk order so the outcome does not depend on scheduling.
+		FrameVector<SnapResult> chunkSnaps(chunkCount, SnapResult{}, _frameArena);
+		_jobs.parallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+			{
+				for (size_t chunk = begin; chunk < end; ++chunk)
+				{
+					size_t first = count * chunk / chunkCount;
+					size_t last = count * (chunk + 1) / chunkCount;
+					chunkSnaps[chunk] = findSnap(rect, dragged, candidates.data() + first, last - first);
+				}
+			});
+
+		for (const SnapResult& chunkSnap : chunkSnaps)
+		{
+			snap.merge(chunkSnap);
+		}
+	}
+
+	if (_alignmentSnapping || _spacingSnapping)
+	{
+		_alignment.refresh([&](Uint32 id) { return isSnapSkipped(id, dragged); });
+	}
+	if (_alignmentSnapping)
+	{
+		offerAlignments(rect, dragged, snap);
+	}
+	if (_spacingSnapping)
+	{
+		offerSpacing(rect, dragged, snap);
+	}
+	if (_grid.isEnabled())
+	{
+		offerGrid(rect, snap);
+	}
+	return snap;
+}
+
+void GuiController::offerGrid(const SDL_Rect& rect, SnapResult& snap) const
+{
+	// The nearest line to either edge is a rounding away.
+	int step = _grid.getStep();
+	auto nearestLine = [step](int coordinate) { return SpatialIndex::floorDiv(coordinate + step / 2, step) * step; };
+	for (int i = 0; i < AlignmentIndex::AxisCount; ++i)
+	{
+		auto axis = static_cast<AlignmentIndex::Axis>(i);
+		AxisSnap& axisSnap = axis == AlignmentIndex::Horizontal ? snap.x : snap.y;
+		int start = AlignmentIndex::getCoordinate(rect, axis, AlignmentIndex::Start);
+		int end = AlignmentIndex::getCoordinate(rect, axis, AlignmentIndex::End);
+		int positions[] = { nearestLine(start), nearestLine(end) - (end - start) };
+		for (int position : positions)
+		{
+			int distance = std::abs(position - start);
+			if (distance <= _threshold)
+			{
+				axisSnap.offer(position, distance, GridTarget);
+			}
+		}
+	}
+}
+
+bool GuiController::findSweptSnap(const SDL_Rect& from, const SDL_Rect& rect, size_t dragged, SnapResult& snap)
+{
+	// Stops at positions along the way no more than the threshold apart on
+	// either axis, so no edge's snap zone is stepped over, and takes the
+	// first that snaps to an edge. Only the axes that snapped are taken from
+	// the stop; the other keeps the pointer's position.
+	int dx = rect.x - from.x;
+	int dy = rect.y - from.y;
+	int distance = std::max(std::abs(dx), std::abs(dy));
+	if (distance <= _threshold)
+	{
+		return false;
+	}
+
+	// The index is queried once, for everything any stop could reach: each
+	// area around the rect stretched from its start to its end.
+	SDL_Rect fromAreas[4];
+	SDL_Rect toAreas[4];
+	int areaCount = getSnapAreas(from, fromAreas);
+	getSnapAreas(rect, toAreas);
+	FrameVector<Uint32> candidates(_frameArena);
+	for (int i = 0; i < areaCount; ++i)
+	{
+		SDL_Rect swept;
+		SDL_UnionRect(&fromAreas[i], &toAreas[i], &swept);
+		_index.query(swept, [&](Uint32 id) { candidates.push_back(id); });
+	}
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	if (candidates.empty())
+	{
+		return false;
+	}
+
+	int steps = std::min((distance + _threshold - 1) / std::max(_threshold, 1), MaxSweepSteps);
+	for (int step = 1; step < steps; ++step)
+	{
+		SDL_Rect stop = { from.x + dx * step / steps, from.y + dy * step / steps, rect.w, rect.h };
+		SnapResult stopSnap = findSnap(stop, dragged, candidates.data(), candidates.size());
+
+		// An axis just let go of starts the sweep on top of the snap it had,
+		// which does not count again; the target's other edges still do.
+		if (isSameSnap(stopSnap.x, _heldSnaps[AlignmentIndex::Horizontal]))
+		{
+			stopSnap.x = AxisSnap{};
+		}
+		if (isSameSnap(stopSnap.y, _heldSnaps[AlignmentIndex::Vertical]))
+		{
+			stopSnap.y = AxisSnap{};
+		}
+		if (stopSnap.x.isSet() || stopSnap.y.isSet())
+		{
+			snap = stopSnap;
+			return true;
+		}
+	}
+	return false;
+}
+
+void GuiController::offerAlignments(const SDL_Rect& rect, size_t dragged, SnapResult& snap)
+{
+	SDL_Rect visible = getVisibleRect();
+	auto skip = [&](Uint32 id) { return isGuideTargetSkipped(id, dragged, visible); };
+	for (int i = 0; i < AlignmentIndex::FeatureCount; ++i)
+	{
+		auto feature = static_cast<AlignmentIndex::Feature>(i);
+		_alignment.offerAlignments(AlignmentIndex::Horizontal, feature,
+			AlignmentIndex::getCoordinate(rect, AlignmentIndex::Horizontal, feature), rect.x, _threshold, snap.x, skip);
+		_alignment.offerAlignments(AlignmentIndex::Vertical, feature,
+			AlignmentIndex::getCoordinate(rect, AlignmentIndex::Vertical, feature), rect.y, _threshold, snap.y, skip);
+	}
+}
+
+void GuiController::offerSpacing(const SDL_Rect& rect, size_t dragged, SnapResult& snap)
+{
+	// The neighbors are found from the sorted edge lists, so each is a binary
+	// search plus a short walk past rects outside the row or column.
+	SDL_Rect visible = getVisibleRect();
+	auto skip = [&](Uint32 id) { return isGuideTargetSkipped(id, dragged, visible); };
+	for (int i = 0; i < AlignmentIndex::AxisCount; ++i)
+	{
+		auto axis = static_cast<AlignmentIndex::Axis>(i);
+		AxisSnap& axisSnap = axis == AlignmentIndex::Horizontal ? snap.x : snap.y;
+		int start = AlignmentIndex::getCoordinate(rect, axis, AlignmentIndex::Start);
+		int size = AlignmentIndex::getCoordinate(rect, axis, AlignmentIndex::End) - start;
+		auto offer = [&](int position, Uint32 target)
+			{
+				int distance = std::abs(position - start);
+				if (distance <= _threshold)
+				{
+					axisSnap.offer(position, distance, target);
+				}
+			};
+		auto startOf = [&](Uint32 id) { return AlignmentIndex::getCoordinate(_alignment.getRect(id), axis, AlignmentIndex::Start); };
+		auto endOf = [&](Uint32 id) { return AlignmentIndex::getCoordinate(_alignment.getRect(id), axis, AlignmentIndex::End); };
+
+		// The rect may still overlap a neighbor by up to the threshold.
+		Uint32* neighbors = _spacingNeighbors[axis];
+		Uint32 before = neighbors[1] = _alignment.findNeighbor(axis, false, rect, _threshold, skip);
+		Uint32 after = neighbors[2] = _alignment.findNeighbor(axis, true, rect, _threshold, skip);
+		neighbors[0] = neighbors[3] = AlignmentIndex::NoId;
+		if (before != AlignmentIndex::NoId)
+		{
+			Uint32 outer = neighbors[0] = _alignment.findNeighbor(axis, false, _alignment.getRect(before), 0, skip);
+			if (outer != AlignmentIndex::NoId)
+			{
+				offer(endOf(before) + startOf(before) - endOf(outer), before);
+			}
+		}
+		if (after != AlignmentIndex::NoId)
+		{
+			Uint32 outer = neighbors[3] = _alignment.findNeighbor(axis, true, _alignment.getRect(after), 0, skip);
+			if (outer != AlignmentIndex::NoId)
+			{
+				offer(startOf(after) - (startOf(outer) - endOf(after)) - size, after);
+			}
+		}
+		if (before != AlignmentIndex::NoId && after != AlignmentIndex::NoId)
+		{
+			int space = startOf(after) - endOf(before) - size;
+			if (space >= 0)
+			{
+				offer(endOf(before) + space / 2, before);
+			}
+		}
+	}
+}
+
+// A line across the gap between before and after along axis, halfway along
+// the stretch where they overlap across it.
+static SDL_Rect getGapLine(AlignmentIndex::Axis axis, const SDL_Rect& before, const SDL_Rect& after)
+{
+	AlignmentIndex::Axis across = axis == AlignmentIndex::Horizontal ? AlignmentIndex::Vertical : AlignmentIndex::Horizontal;
+	int from = AlignmentIndex::getCoordinate(before, axis, AlignmentIndex::End);
+	int to = AlignmentIndex::getCoordinate(after, axis, AlignmentIndex::Start);
+	int overlapStart = std::max(AlignmentIndex::getCoordinate(before, across, AlignmentIndex::Start),
+		AlignmentIndex::getCoordinate(after, across, AlignmentIndex::Start));
+	int overlapEnd = std::min(AlignmentIndex::getCoordinate(before, across, AlignmentIndex::End),
+		AlignmentIndex::getCoordinate(after, across, AlignmentIndex::End));
+	int middle = overlapStart + (overlapEnd - overlapStart) / 2;
+	return axis == AlignmentIndex::Horizontal ?
+		SDL_Rect{ from, middle, to - from, 0 } : SDL_Rect{ middle, from, 0, to - from };
+}
+
+void GuiController::addSpacingGuides(const SDL_Rect& rect)
+{
+	// Marks every gap around the snapped rect that equals another one next
+	// to it, among the neighbors offerSpacing() measured: the gaps on either
+	// side of the rect, and the ones just beyond its neighbors. A neighbor
+	// the snap moved the rect out of line with, or into, counts for nothing.
+	for (int i = 0; i < AlignmentIndex::AxisCount; ++i)
+	{
+		auto axis = static_cast<AlignmentIndex::Axis>(i);
+		auto across = axis == AlignmentIndex::Horizontal ? AlignmentIndex::Vertical : AlignmentIndex::Horizontal;
+		const SDL_Rect* rects[5] = { nullptr, nullptr, &rect, nullptr, nullptr };
+		for (int j = 0; j < 4; ++j)
+		{
+			Uint32 id = _spacingNeighbors[axis][j];
+			if (id != AlignmentIndex::NoId)
+			{
+				rects[j < 2 ? j : j + 1] = &_alignment.getRect(id);
+			}
+		}
+		for (int j : { 1, 3 })
+		{
+			if (rects[j] && (AlignmentIndex::getCoordinate(*rects[j], across, AlignmentIndex::End) <= AlignmentIndex::getCoordinate(rect, across, AlignmentIndex::Start) ||
+				AlignmentIndex::getCoordinate(rect, across, AlignmentIndex::End) <= AlignmentIndex::getCoordinate(*rects[j], across, AlignmentIndex::Start)))
+			{
+				rects[j] = nullptr;
+			}
+		}
+
+		// Gaps in order along the axis: beyond before, before the rect, after
+		// it and beyond after; zero where a neighbor is missing.
+		int gaps[4];
+		for (int j = 0; j < 4; ++j)
+		{
+			const SDL_Rect* first = rects[j];
+			const SDL_Rect* second = rects[j + 1];
+			gaps[j] = first && second ? AlignmentIndex::getCoordinate(*second, axis, AlignmentIndex::Start) -
+				AlignmentIndex::getCoordinate(*first, axis, AlignmentIndex::End) : 0;
+		}
+
+		bool marked[4] = {};
+		for (int j = 0; j < 3; ++j)
+		{
+			if (gaps[j] > 0 && gaps[j] == gaps[j + 1])
+			{
+				marked[j] = marked[j + 1] = true;
+			}
+		}
+		for (int j = 0; j < 4 && _guideCount < MaxGuides; ++j)
+		{
+			if (marked[j])
+			{
+				_guides[_guideCount++] = getGapLine(axis, *rects[j], *rects[j + 1]);
+			}
+		}
+	}
+}
+
+void GuiController::updateGuides(const SDL_Rect& rect, const SnapResult& snap)
+{
+	// A guide is drawn for each axis the rect snapped on by lining up with
+	// the same edge or center of its target, spanning both of them.
+	_guideCount = 0;
+	for (int i = 0; i < AlignmentIndex::AxisCount; ++i)
+	{
+		auto axis = static_cast<AlignmentIndex::Axis>(i);
+		const AxisSnap& axisSnap = axis == AlignmentIndex::Horizontal ? snap.x : snap.y;
+		if (!axisSnap.isSet() || axisSnap.target == GridTarget)
+		{
+			continue;
+		}
+
+		const SDL_Rect& target = _index.getRect(static_cast<Uint32>(axisSnap.target));
+		for (int j = 0; j < AlignmentIndex::FeatureCount; ++j)
+		{
+			auto feature = static_cast<AlignmentIndex::Feature>(j);
+			int coordinate = AlignmentIndex::getCoordinate(rect, axis, feature);
+			if (coordinate != AlignmentIndex::getCoordinate(target, axis, feature))
+			{
+				continue;
+			}
+
+			SDL_Rect span;
+			SDL_UnionRect(&rect, &target, &span);
+			_guides[_guideCount++] = axis == AlignmentIndex::Horizontal ?
+				SDL_Rect{ coordinate, span.y, 0, span.h } : SDL_Rect{ span.x, coordinate, span.w, 0 };
+			break;
+		}
+	}
+
+	if (_spacingSnapping)
+	{
+		addSpacingGuides(rect);
+	}
+}
+
+SnapResult GuiController::findSnap(const SDL_Rect& rect, size_t dragged, const Uint32* candidates, size_t count) const
+{
+	SnapResult snap;
+	size_t tested = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		size_t index = candidates[i];
+		auto& other = _components[index];
+		if (isSnapSkipped(index, dragged))
+		{
+			// Skip self and other components being dragged.
+			continue;
+		}
+
+		++tested;
+		int distance;
+		auto nearSide = whichSideIsNear(rect, other->getRect(), _threshold, distance);
+		if (nearSide != RectSide::None)
+		{
+			snap.offerEdge(nearSide, rect, other->getRect(), distance, index);
+		}
+	}
+
+	// Once per chunk rather than per pair.
+	Metrics::add(Metric::SnapPairsTested, tested);
+	return snap;
+}
+
+void GuiController::update()
+{
+	AllocationPhaseScope phase(FramePhase::Update);
+
+	// Everything a group drag did since the last frame lands at once.
+	applyGroupDrag();
+
+	// Components that declared themselves thread-safe are spread across the
+	// job system first; the rest then run in order on the calling thread.
+	_jobs.parallelFor(_parallelUpdates.size(), 256, [this](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				_components[_parallelUpdates[i]]->update();
+			}
+		});
+
+	for (size_t index : _serialUpdates)
+	{
+		_components[index]->update();
+	}
+	for (auto& overlay : _overlays)
+	{
+		overlay->update();
+	}
+
+	// Pick up whatever the updates moved.
+	for (size_t index : _parallelUpdates)
+	{
+		syncIndex(index);
+	}
+	for (size_t index : _serialUpdates)
+	{
+		syncIndex(index);
+	}
+
+	// Records the writer had no room for are retried once a frame, not only
+	// when the next edit comes in.
+	if (_journal)
+	{
+		_journal->flushPending();
+	}
+}
+
+int GuiController::getLodLevel() const
+{
+	return _lodPixels > 0 ? LodPyramid::getLevel(_camera.zoom, _lodPixels) : 0;
+}
+
+void GuiController::collectVisible(FrameVector<Uint32>& visible, int lodLevel) const
+{
+	// Back to front, like the component list. Index levels below the LOD
+	// level are covered by the pyramid.
+	_index.query(_camera.getVisibleRect(_viewportWidth, _viewportHeight), [&](Uint32 id) { visible.push_back(id); }, lodLevel);
+	std::sort(visible.begin(), visible.end());
+}
+
+void GuiController::cullOccluded(FrameVector<Uint32>& visible)
+{
+	_occlusion.reset(_viewportWidth, _viewportHeight);
+	if (!_occlusionCulling)
+	{
+		return;
+	}
+
+	// Front to back, keeping what is not hidden by opaque components already
+	// seen, packed towards the end so the order is kept.
+	size_t kept = visible.size();
+	for (size_t i = visible.size(); i-- > 0;)
+	{
+		const GuiComponent& component = *_components[visible[i]];
+		SDL_Rect screenRect = _camera.toScreen(component.getRect());
+		if (_occlusion.isCovered(screenRect))
+		{
+			continue;
+		}
+
+		if (component.isOpaque())
+		{
+			_occlusion.addOccluder(screenRect);
+		}
+		visible[--kept] = visible[i];
+	}
+
+	Metrics::add(Metric::ComponentsCulled, kept);
+	visible.erase(visible.begin(), visible.begin() + kept);
+}
+
+void GuiController::renderLod(int lodLevel)
+{
+	// All cells go out in one geometry call, with the color per vertex.
+	FrameVector<SDL_Vertex> vertices(_frameArena);
+	FrameVector<int> indices(_frameArena);
+	_lod.forEachCell(lodLevel, _camera.getVisibleRect(_viewportWidth, _viewportHeight), [&](const SDL_Rect& cell, const SDL_Color& color)
+		{
+			SDL_Rect screenRect = _camera.toScreen(cell);
+			if (isOccluded(screenRect))
+			{
+				return;
+			}
+
+			float x0 = static_cast<float>(screenRect.x);
+			float y0 = static_cast<float>(screenRect.y);
+			float x1 = static_cast<float>(screenRect.x + screenRect.w);
+			float y1 = static_cast<float>(screenRect.y + screenRect.h);
+
+			int base = static_cast<int>(vertices.size());
+			vertices.push_back({ { x0, y0 }, color, { 0.0f, 0.0f } });
+			vertices.push_back({ { x1, y0 }, color, { 0.0f, 0.0f } });
+			vertices.push_back({ { x1, y1 }, color, { 0.0f, 0.0f } });
+			vertices.push_back({ { x0, y1 }, color, { 0.0f, 0.0f } });
+			for (int corner : { 0, 1, 2, 0, 2, 3 })
+			{
+				indices.push_back(base + corner);
+			}
+		});
+
+	if (!indices.empty())
+	{
+		SDL_RenderGeometry(_renderer, nullptr, vertices.data(), static_cast<int>(vertices.size()),
+			indices.data(), static_cast<int>(indices.size()));
+		Metrics::add(Metric::DrawCalls);
+		Metrics::add(Metric::LodCellsDrawn, vertices.size() / 4);
+	}
+}
+
+void GuiController::render()
 {
-	for (auto it = _components.rbegin(); it != _components.rend(); ++it)
+	AllocationPhaseScope phase(FramePhase::Render);
+	beginFrame();
+
+	SDL_SetRenderDrawColor(_renderer, 255, 255, 255, 255); // Set background color to white with full alpha
+	SDL_RenderClear(_renderer); // Clear the screen with the background color
+	Metrics::add(Metric::DrawCalls);
+	if (_grid.isEnabled())
+	{
+		_grid.render(_camera, _viewportWidth, _viewportHeight);
+	}
+
+	// Coarse cells go underneath the components that are still big enough to
+	// draw one by one; both skip what those components hide.
+	int lodLevel = getLodLevel();
+	FrameVector<Uint32> visible(_frameArena);
+	collectVisible(visible, lodLevel);
+	cullOccluded(visible);
+	if (lodLevel > 0)
+	{
+		renderLod(lodLevel);
+	}
+
+	Metrics::add(Metric::ComponentsDrawn, visible.size());
+	for (Uint32 id : visible)
+	{
+		_components[id]->render(_camera);
+	}
+
+	if (_guideCount > 0)
 	{
-		auto& guiComponent = *it;
-		if (guiComponent->handleEvent(event))
+		SDL_SetRenderDrawColor(_renderer, GuideColor.r, GuideColor.g, GuideColor.b, GuideColor.a);
+		for (int i = 0; i < _guideCount; ++i)
 		{
-			if (guiComponent->isDragging())
-			{
-				for (auto& other : _components)
+			SDL_Rect line = _camera.toScreen(_guides[i]);
+			SDL_RenderDrawLine(_renderer, line.x, line.y, line.x + line.w, line.y + line.h);
+		}
+		Metrics::add(Metric::DrawCalls, _guideCount);
+	}
+
+	if (_selecting)
+	{
+		SDL_Rect band = _camera.toScreen(_band);
+		SDL_SetRenderDrawColor(_renderer, BandColor.r, BandColor.g, BandColor.b, BandColor.a);
+		SDL_RenderDrawRect(_renderer, &band);
+		Metrics::add(Metric::DrawCalls);
+	}
+
+	const Camera screen;
+	for (auto& overlay : _overlays)
+	{
+		overlay->render(screen);
+	}
+
+	if (_hudVisible)
+	{
+		if (!_hud)
+		{
+			_hud = std::make_unique<PerformanceHud>(_renderer);
+		}
+		MetricValues lastFrame = Metrics::getLastFrame();
+		_hud->render({ _components.size(), lastFrame[Metric::ComponentsCulled], lastFrame[Metric::DrawCalls] }, _frameArena);
+	}
+
+	// Input handled since the last frame becomes visible with this one.
+	if (_hud && _pendingInputTimestamp != 0)
+	{
+		_hud->recordInputLatency(static_cast<double>(SDL_GetTicks() - _pendingInputTimestamp));
+	}
+	_pendingInputTimestamp = 0;
+
+	SDL_RenderPresent(_renderer); // Show what has been drawn so far
+
+	finishFrame();
+}
+
+void GuiController::buildSnapshot(RenderSnapshot& snapshot)
+{
+	{
+		AllocationPhaseScope phase(FramePhase::Render);
+		beginFrame();
+
+		// Reuse the previous contents' storage.
+		snapshot.items.clear();
+		if (_grid.isEnabled())
+		{
+			_grid.appendToSnapshot(snapshot, _camera, _viewportWidth, _viewportHeight);
+		}
+
+		int lodLevel = getLodLevel();
+		FrameVector<Uint32> visible(_frameArena);
+		collectVisible(visible, lodLevel);
+		cullOccluded(visible);
+		if (lodLevel > 0)
+		{
+			size_t before = snapshot.items.size();
+			_lod.forEachCell(lodLevel, _camera.getVisibleRect(_viewportWidth, _viewportHeight), [&](const SDL_Rect& cell, const SDL_Color& color)
 				{
-					if (other == guiComponent || other->isDragging())
+					SDL_Rect screenRect = _camera.toScreen(cell);
+					if (!isOccluded(screenRect))
 					{
-						// Skip self and other components being dragged.
-						continue;
+						snapshot.items.push_back({ screenRect, color });
 					}
+				});
+			Metrics::add(Metric::LodCellsDrawn, snapshot.items.size() - before);
+		}
 
-					auto nearSide = whichSideIsNear(guiComponent->getRect(), other->getRect(), _threshold);
-					if (nearSide == RectSide::None)
-					{
-						continue;
-					}
-					
-					// Snap to other component.
-					auto rect = guiComponent->getRect();
-					auto otherRect = other->getRect();
+		Metrics::add(Metric::ComponentsDrawn, visible.size());
+		for (Uint32 id : visible)
+		{
+			_components[id]->appendToSnapshot(snapshot, _camera);
+		}
+		for (int i = 0; i < _guideCount; ++i)
+		{
+			SDL_Rect line = _camera.toScreen(_guides[i]);
+			snapshot.items.push_back({ { line.x, line.y, std::max(line.w, 1), std::max(line.h, 1) }, GuideColor });
+		}
+		if (_selecting)
+		{
+			appendOutline(snapshot, _camera.toScreen(_band), BandColor);
+		}
+	}
 
-					// Adjust position based on which edge is closest.
-					switch (nearSide)
-					{
-					case RectSide::Left:
-						rect.x = otherRect.x - rect.w;
-						break;
-					case RectSide::Right:
-						rect.x = otherRect.x + otherRect.w;
-						break;
-					case RectSide::Top:
-						rect.y = otherRect.y - rect.h;
-						break;
-					case RectSide::Bottom:
-						rect.y = otherRect.y + otherRect.h;
-						break;
-					}
+	finishFrame();
+}
 
-					guiComponent->setRect(rect);
-				}
-			}
+void GuiController::beginFrame()
+{
+	// The damage gathered since the last frame lives in the half of the arena
+	// that stays valid through this one; new damage goes to the other half.
+	_frameDamage = std::move(_damage);
+	_frameArena.beginFrame();
+	_damage = FrameVector<SDL_Rect>(_frameArena);
+	_frameViewChanged = _viewChanged;
+	_viewChanged = false;
 
-			break;
+	// Summed per rect on screen, so pixels covered by several rects count
+	// more than once. A camera move redraws the whole viewport.
+	SDL_Rect viewport = { 0, 0, _viewportWidth, _viewportHeight };
+	Uint64 damagedPixels = static_cast<Uint64>(_viewportWidth) * _viewportHeight;
+	if (!_frameViewChanged)
+	{
+		damagedPixels = 0;
+		for (const SDL_Rect& rect : _frameDamage)
+		{
+			SDL_Rect screenRect = _camera.toScreen(rect);
+			SDL_Rect clipped;
+			if (SDL_IntersectRect(&screenRect, &viewport, &clipped))
+			{
+				damagedPixels += static_cast<Uint64>(clipped.w) * clipped.h;
+			}
 		}
 	}
+	Metrics::add(Metric::DamagedPixels, damagedPixels);
 }
 
-void GuiController::render()
+void GuiController::finishFrame()
 {
-	SDL_SetRenderDrawColor(_renderer, 255, 255, 255, 255); // Set background color to white with full alpha
-	SDL_RenderClear(_renderer); // Clear the screen with the background color
+	// A frame ends once it has been drawn or captured; the next one counts as
+	// steady if a drag has been going on for a while.
+	_dragFrames = _dragActive ? _dragFrames + 1 : 0;
+	AllocationTracker::endFrame();
+	AllocationTracker::setSteadyState(_dragFrames >= SteadyDragFrames);
 
-	for (auto& component : _components)
+	// Frame time is measured from the end of one frame to the end of the next.
+	Uint64 now = SDL_GetPerformanceCounter();
+	if (_frameEndCounter != 0)
 	{
-		component->render();
+		Uint64 microseconds = (now - _frameEndCounter) * 1000000 / SDL_GetPerformanceFrequency();
+		Metrics::add(Metric::FrameMicroseconds, microseconds);
+		if (_hud)
+		{
+			_hud->recordFrame(microseconds / 1000.0);
+		}
 	}
-
-	SDL_RenderPresent(_renderer); // Show what has been drawn so far
+	_frameEndCounter = now;
+	Metrics::publishFrame();
 }
 
 void GuiController::addComponent(std::unique_ptr<GuiComponent> component)
 {
+	if (_journal)
+	{
+		_journal->recordAdd(static_cast<Uint32>(_components.size()), component->getRect(), component->getColor());
+	}
+
+	if (component->hasUpdate())
+	{
+		auto& updates = component->isUpdateThreadSafe() ? _parallelUpdates : _serialUpdates;
+		updates.push_back(_components.size());
+	}
+
+	_index.insert(static_cast<Uint32>(_components.size()), component->getRect());
+	_alignment.insert(static_cast<Uint32>(_components.size()), component->getRect());
+	_lod.insert(static_cast<Uint32>(_components.size()), component->getRect(), component->getColor());
+	addDamage(component->getRect());
+	component->setFrameArena(&_frameArena);
 	_components.push_back(std::move(component));
+	_selectionSlots.push_back(NoSlot);
+	refreshSelection(static_cast<Uint32>(_components.size() - 1));
+}
+
+void GuiController::addOverlay(std::unique_ptr<GuiComponent> overlay)
+{
+	overlay->setFrameArena(&_frameArena);
+	_overlays.push_back(std::move(overlay));
+}
+
+void GuiController::addDamage(const SDL_Rect& rect)
+{
+	_damage.push_back(rect);
+
+	if (_hoverValid && SDL_HasIntersection(&rect, &_hoverArea))
+	{
+		_hoverValid = false;
+	}
+
+	if (_idsValid)
+	{
+		if (_idDamage.size() < MaxIdDamage)
+		{
+			_idDamage.push_back(rect);
+		}
+		else
+		{
+			_idsValid = false;
+			_idDamage.clear();
+		}
+	}
+}
+
+void GuiController::setPickingBuffer(bool enabled)
+{
+	_picking = enabled;
+	_idsValid = false;
+	_idDamage.clear();
+	if (enabled)
+	{
+		_idDamage.reserve(MaxIdDamage);
+	}
+}
+
+Uint32 GuiController::pick(int x, int y)
+{
+	if (!_idsValid)
+	{
+		_ids.reset(_viewportWidth, _viewportHeight);
+		redrawIds({ 0, 0, _viewportWidth, _viewportHeight });
+		_idsValid = true;
+	}
+	else
+	{
+		for (const SDL_Rect& rect : _idDamage)
+		{
+			redrawIds(_camera.toScreen(rect));
+		}
+	}
+	_idDamage.clear();
+
+	return _ids.get(x, y);
+}
+
+void GuiController::redrawIds(const SDL_Rect& screenRect)
+{
+	SDL_Rect screen = { 0, 0, _ids.getWidth(), _ids.getHeight() };
+	SDL_Rect area;
+	if (!SDL_IntersectRect(&screenRect, &screen, &area))
+	{
+		return;
+	}
+
+	// Clear the area, then draw every component that reaches into it back to
+	// front, the same way render() maps rects to pixels.
+	_ids.fill(area, area, IdBuffer::NoId);
+
+	SDL_Point topLeft = _camera.toWorld(area.x, area.y);
+	SDL_Point bottomRight = _camera.toWorld(area.x + area.w, area.y + area.h);
+	SDL_Rect world = { topLeft.x, topLeft.y, bottomRight.x - topLeft.x + 1, bottomRight.y - topLeft.y + 1 };
+
+	FrameVector<Uint32> ids(_frameArena);
+	_index.query(world, [&](Uint32 id) { ids.push_back(id); });
+	std::sort(ids.begin(), ids.end());
+	for (Uint32 id : ids)
+	{
+		_ids.fill(_camera.toScreen(_components[id]->getRect()), area, id);
+	}
+}
+
+// Shrinks area so it no longer overlaps obstacle, which must not contain
+// point, keeping point inside and as much of area as one cut allows.
+static void excludeRect(SDL_Rect& area, const SDL_Rect& obstacle, const SDL_Point& point)
+{
+	if (!SDL_HasIntersection(&area, &obstacle))
+	{
+		return;
+	}
+
+	int right = area.x + area.w;
+	int bottom = area.y + area.h;
+	SDL_Rect best = area;
+	Sint64 bestSize = -1;
+	auto offer = [&](int left, int top, int cutRight, int cutBottom)
+		{
+			Sint64 size = static_cast<Sint64>(cutRight - left) * (cutBottom - top);
+			if (size > bestSize)
+			{
+				best = { left, top, cutRight - left, cutBottom - top };
+				bestSize = size;
+			}
+		};
+	if (point.x < obstacle.x)
+	{
+		offer(area.x, area.y, obstacle.x, bottom);
+	}
+	if (point.x >= obstacle.x + obstacle.w)
+	{
+		offer(obstacle.x + obstacle.w, area.y, right, bottom);
+	}
+	if (point.y < obstacle.y)
+	{
+		offer(area.x, area.y, right, obstacle.y);
+	}
+	if (point.y >= obstacle.y + obstacle.h)
+	{
+		offer(area.x, obstacle.y + obstacle.h, right, bottom);
+	}
+	area = best;
+}
+
+Uint32 GuiController::findHovered(const SDL_Point& point)
+{
+	if (_hoverValid && SDL_PointInRect(&point, &_hoverRect))
+	{
+		return _hoverHit;
+	}
+
+	if (!_hoverValid || !SDL_PointInRect(&point, &_hoverArea))
+	{
+		Metrics::add(Metric::HoverQueries);
+		int size = std::max(static_cast<int>(std::ceil(HoverAreaPixels / _camera.zoom)), 1);
+		_hoverArea = { point.x - size / 2, point.y - size / 2, size, size };
+		_hoverNeighbors.clear();
+		_index.query(_hoverArea, [&](Uint32 id) { _hoverNeighbors.push_back(id); });
+		_hoverValid = true;
+	}
+
+	// The hit is the topmost neighbor under the point; everything above it
+	// is then cut out of the rect, which ends up inside the hit itself.
+	_hoverHit = IdBuffer::NoId;
+	_hoverRect = _hoverArea;
+	for (Uint32 id : _hoverNeighbors)
+	{
+		if ((_hoverHit == IdBuffer::NoId || id > _hoverHit) && SDL_PointInRect(&point, &_index.getRect(id)))
+		{
+			_hoverHit = id;
+		}
+	}
+	if (_hoverHit != IdBuffer::NoId)
+	{
+		SDL_IntersectRect(&_hoverRect, &_index.getRect(_hoverHit), &_hoverRect);
+	}
+	for (Uint32 id : _hoverNeighbors)
+	{
+		if (_hoverHit == IdBuffer::NoId || id > _hoverHit)
+		{
+			excludeRect(_hoverRect, _index.getRect(id), point);
+		}
+	}
+	return _hoverHit;
+}
+
+void GuiController::setHovered(Uint32 id)
+{
+	if (id == _hovered)
+	{
+		return;
+	}
+
+	if (_hovered != IdBuffer::NoId)
+	{
+		_components[_hovered]->onHoverLeave();
+	}
+	_hovered = id;
+	if (id != IdBuffer::NoId)
+	{
+		_components[id]->onHoverEnter();
+	}
+}
+
+void GuiController::beginSelectionBand(const SDL_Point& anchor, Uint32 toggle)
+{
+	Metrics::add(Metric::EventsConsumed);
+	_selecting = true;
+	_bandStarted = false;
+	_bandAnchor = anchor;
+	_bandToggle = toggle;
+	_band = { anchor.x, anchor.y, 0, 0 };
+}
+
+void GuiController::moveSelectionBand(const SDL_Point& point)
+{
+	// The band replaces the selection once the pointer actually moves.
+	if (!_bandStarted)
+	{
+		clearSelection();
+		_bandStarted = true;
+	}
+	setSelectionBand({ std::min(_bandAnchor.x, point.x), std::min(_bandAnchor.y, point.y),
+		std::abs(point.x - _bandAnchor.x), std::abs(point.y - _bandAnchor.y) });
+}
+
+void GuiController::endSelectionBand()
+{
+	if (!_bandStarted && _bandToggle != IdBuffer::NoId)
+	{
+		setSelected(_bandToggle, !isSelected(_bandToggle));
+	}
+	_selecting = false;
+}
+
+void GuiController::setSelectionBand(const SDL_Rect& band)
+{
+	// The selection is what overlaps the old band. Whatever overlaps only the
+	// new one reaches into the part of it outside the old one, and the other
+	// way round, so those strips are all that is queried.
+	SDL_Rect old = _band;
+	_band = band;
+
+	SDL_Rect strips[8];
+	int count = subtractRect(band, old, strips);
+	count += subtractRect(old, band, strips + count);
+	for (int i = 0; i < count; ++i)
+	{
+		_index.query(strips[i], [this](Uint32 id) { refreshSelection(id); });
+	}
+}
+
+void GuiController::refreshSelection(Uint32 id)
+{
+	// Only a band that is still out keeps following what moves. Rects with
+	// no area are never selected.
+	if (_selecting && _bandStarted)
+	{
+		setSelected(id, SDL_HasIntersection(&_index.getRect(id), &_band) == SDL_TRUE);
+	}
+}
+
+void GuiController::setSelected(Uint32 id, bool selected)
+{
+	Uint32& slot = _selectionSlots[id];
+	if (selected == (slot != NoSlot))
+	{
+		return;
+	}
+
+	if (selected)
+	{
+		slot = static_cast<Uint32>(_selection.size());
+		_selection.push_back(id);
+		_components[id]->onSelected();
+	}
+	else
+	{
+		// Swap the last one into the freed slot.
+		Uint32 last = _selection.back();
+		_selection[slot] = last;
+		_selectionSlots[last] = slot;
+		_selection.pop_back();
+		slot = NoSlot;
+		_components[id]->onDeselected();
+	}
+}
+
+void GuiController::clearSelection()
+{
+	for (Uint32 id : _selection)
+	{
+		_selectionSlots[id] = NoSlot;
+		_components[id]->onDeselected();
+	}
+	_selection.clear();
+}
+
+void GuiController::beginGroupDrag(const SDL_Point& grab)
+{
+	Metrics::add(Metric::EventsConsumed);
+	_groupDragging = true;
+	_groupGrab = grab;
+	_groupOffset = { 0, 0 };
+	_groupApplied = { 0, 0 };
+
+	_groupIds.assign(_selection.begin(), _selection.end());
+	_groupOrigins.clear();
+	for (Uint32 id : _groupIds)
+	{
+		_groupOrigins.push_back(_index.getRect(id));
+	}
+	_groupBounds = _groupOrigins.front();
+	for (const SDL_Rect& rect : _groupOrigins)
+	{
+		SDL_UnionRect(&_groupBounds, &rect, &_groupBounds);
+	}
+}
+
+void GuiController::moveGroup(const SDL_Point& point)
+{
+	_dragActive = true;
+
+	// The selection snaps as one box, against everything not in it.
+	SDL_Rect bounds = _groupBounds;
+	bounds.x += point.x - _groupGrab.x;
+	bounds.y += point.y - _groupGrab.y;
+
+	AllocationPhaseScope snapPhase(FramePhase::Snap);
+	Uint64 snapStart = SDL_GetPerformanceCounter();
+	SDL_Rect previous = { _groupBounds.x + _groupOffset.x, _groupBounds.y + _groupOffset.y, _groupBounds.w, _groupBounds.h };
+	SnapResult snap = snapDrag(previous, bounds, GroupDrag);
+	if (snap.x.isSet() || snap.y.isSet())
+	{
+		Metrics::add(Metric::SnapsApplied);
+	}
+	bounds = snap.apply(bounds);
+	updateGuides(bounds, snap);
+	_snapTicks += SDL_GetPerformanceCounter() - snapStart;
+
+	_groupOffset = { bounds.x - _groupBounds.x, bounds.y - _groupBounds.y };
+}
+
+void GuiController::applyGroupDrag()
+{
+	if (!_groupDragging || (_groupOffset.x == _groupApplied.x && _groupOffset.y == _groupApplied.y))
+	{
+		return;
+	}
+
+	// New rects in one pass over contiguous storage, then handed out.
+	size_t count = _groupIds.size();
+	int dx = _groupOffset.x;
+	int dy = _groupOffset.y;
+	FrameVector<SDL_Rect> rects(count, SDL_Rect{}, _frameArena);
+	const SDL_Rect* origins = _groupOrigins.data();
+	SDL_Rect* moved = rects.data();
+	for (size_t i = 0; i < count; ++i)
+	{
+		moved[i] = { origins[i].x + dx, origins[i].y + dy, origins[i].w, origins[i].h };
+	}
+
+	// Damage is the group's bounds before and after rather than every member.
+	SDL_Rect before = { _groupBounds.x + _groupApplied.x, _groupBounds.y + _groupApplied.y, _groupBounds.w, _groupBounds.h };
+	SDL_Rect after = { _groupBounds.x + dx, _groupBounds.y + dy, _groupBounds.w, _groupBounds.h };
+	addDamage(before);
+	addDamage(after);
+	for (size_t i = 0; i < count; ++i)
+	{
+		Uint32 id = _groupIds[i];
+		_components[id]->setRect(moved[i]);
+		_index.update(id, moved[i]);
+		_alignment.update(id, moved[i]);
+		_lod.update(id, moved[i], _components[id]->getColor());
+	}
+	_groupApplied = _groupOffset;
+}
+
+void GuiController::endGroupDrag()
+{
+	applyGroupDrag();
+	_groupDragging = false;
+
+	// Only where the group was dropped goes to the journal, as one entry
+	// however large the selection.
+	if (_journal && (_groupApplied.x != 0 || _groupApplied.y != 0))
+	{
+		std::vector<JournalRecord> moves;
+		moves.reserve(_groupIds.size());
+		for (Uint32 id : _groupIds)
+		{
+			moves.push_back({ JournalRecord::Type::Move, id, _components[id]->getRect(), {} });
+		}
+		_journal->recordBatch(std::move(moves));
+	}
+}
+
+int GuiController::findComponentAt(int x, int y)
+{
+	if (_picking)
+	{
+		Uint32 picked = pick(x, y);
+		return picked == IdBuffer::NoId ? -1 : static_cast<int>(picked);
+	}
+
+	SDL_Point point = _camera.toWorld(x, y);
+	int topmost = -1;
+	_index.query({ point.x, point.y, 1, 1 }, [&](Uint32 id) { topmost = std::max(topmost, static_cast<int>(id)); });
+	return topmost;
+}
+
+void GuiController::setComponentColor(int index, const SDL_Color& color)
+{
+	_components[index]->setColor(color);
+	addDamage(_components[index]->getRect());
+	_lod.update(static_cast<Uint32>(index), _components[index]->getRect(), color);
+
+	if (_journal)
+	{
+		_journal->recordRecolor(static_cast<Uint32>(index), color);
+	}
 }
\ No newline at end of file
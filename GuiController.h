@@ -1,22 +1,355 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
+#include "AlignmentIndex.h"
+#include "AllocationTracker.h"
+#include "AutosaveJournal.h"
+#include "Camera.h"
 #include "Enums.h"
+#include "FrameArena.h"
+#include "GridLayer.h"
 #include "GuiComponent.h"
+#include "IdBuffer.h"
+#include "JobSystem.h"
+#include "LodPyramid.h"
+#include "OcclusionBuffer.h"
+#include "PerformanceHud.h"
+#include "Snapping.h"
+#include "SpatialIndex.h"
 
 class GuiController
 {
 public:
-	GuiController(SDL_Renderer* renderer) : _renderer(renderer) {}
+	GuiController(SDL_Renderer* renderer);
 
 	void handleEvent(const SDL_Event& event);
+	void update();
 	void render();
+
+	// Fills snapshot with the current frame instead of drawing it.
+	void buildSnapshot(RenderSnapshot& snapshot);
+
 	void addComponent(std::unique_ptr<GuiComponent> component);
 
+	// Overlays sit in screen coordinates above the canvas, e.g. a minimap.
+	// They get events before any component does and are drawn last by
+	// render(), but are not indexed, snapped against, journaled or part of
+	// snapshots.
+	void addOverlay(std::unique_ptr<GuiComponent> overlay);
+
+	// Returns the index of the topmost component under the screen point, or -1.
+	int findComponentAt(int x, int y);
+
+	// Index of the component the pointer was last over, or -1. Kept up to date
+	// from motion events, which go to it and to components holding on to the
+	// pointer only.
+	int getHoveredComponent() const { return _hovered == IdBuffer::NoId ? -1 : static_cast<int>(_hovered); }
+	void setComponentColor(int index, const SDL_Color& color);
+
+	// A left press on empty canvas, or a Shift-drag anywhere, starts a rubber
+	// band. While it is out, the selection is whatever overlaps it; it stays
+	// once the button is released. Shift-click toggles a single component.
+	//
+	// Dragging a selected component moves the whole selection, snapped as
+	// one box against everything else. Members take the drag in update(), so
+	// the spatial index is updated once per frame however many motion events
+	// came in.
+	void clearSelection();
+	const std::vector<Uint32>& getSelection() const { return _selection; }
+	bool isSelected(int index) const { return _selectionSlots[index] != NoSlot; }
+
+	// Middle-button drag pans and the mouse wheel zooms around the pointer;
+	// the camera can also be set directly.
+	const Camera& getCamera() const { return _camera; }
+
+	// Screen position of the pointer as of the last mouse event handled, so
+	// it is in step with the events this thread has seen.
+	SDL_Point getPointerPosition() const { return _pointer; }
+	void setCamera(const Camera& camera);
+	SDL_Rect getVisibleRect() const { return _camera.getVisibleRect(_viewportWidth, _viewportHeight); }
+
+	// Components that would be drawn smaller than this many pixels across are
+	// drawn from the LOD pyramid instead, one fill per coarse cell. Pass 0 to
+	// always draw components individually.
+	void setLodThreshold(int pixels) { _lodPixels = pixels; }
+
+	// Answers hit tests from a screen-sized buffer of component indices,
+	// refreshed from damage when the next test needs it, instead of querying
+	// the spatial index. Pointer events then go only to the topmost component
+	// under the pointer and to those holding on to it, never to the ones
+	// underneath. Off by default.
+	void setPickingBuffer(bool enabled);
+
+	// Besides abutting edges, a dragged rect snaps to line up its left,
+	// center or right, and top, middle or bottom, with the same of another
+	// component in view, and a guide line shows the alignment. On by
+	// default.
+	void setAlignmentSnapping(bool enabled) { _alignmentSnapping = enabled; }
+
+	// A dragged rect also snaps to repeat the gap between its nearest
+	// neighbor in a row or column and the next one out, or to sit midway
+	// between its neighbors on either side, with the equal gaps marked.
+	// On by default.
+	void setSpacingSnapping(bool enabled) { _spacingSnapping = enabled; }
+
+	// Draws a grid behind the components with a line every spacing /
+	// subdivisions world units, every subdivisions-th of them stronger, and
+	// snaps dragged edges to its lines. On each axis the nearer of a grid
+	// line and a component wins. A spacing of 0, the default, turns it off.
+	void setGrid(int spacing, int subdivisions = 1) { _grid.setGrid(spacing, subdivisions); }
+	int getGridSpacing() const { return _grid.getSpacing(); }
+
+	// When a drag step lands where nothing snaps, also looks along the way
+	// from the last position and stops at the first edge it would have
+	// snapped to, so a fast flick does not jump over a neighbor. Off by
+	// default.
+	void setSweptSnapping(bool enabled) { _sweptSnapping = enabled; }
+
+	// Skips components hidden behind opaque ones in front of them. On by
+	// default; the number skipped per frame is the components_culled metric.
+	void setOcclusionCulling(bool enabled) { _occlusionCulling = enabled; }
+
+	// Size of the area the controller draws into, in pixels. Taken from the
+	// renderer on construction and kept up to date from window size events.
+	void setViewportSize(int width, int height);
+	int getViewportWidth() const { return _viewportWidth; }
+	int getViewportHeight() const { return _viewportHeight; }
+
+	// Scratch memory for the current frame. It is reset at the start of every
+	// render() or buildSnapshot(); allocations stay valid until the one after.
+	FrameArena& getFrameArena() { return _frameArena; }
+
+	// World areas whose contents changed since the previous frame: the old and
+	// new rect of every moved, recolored or added component. Valid until the
+	// next render.
+	const FrameVector<SDL_Rect>& getFrameDamage() const { return _frameDamage; }
+
+	// True if the camera or viewport changed since the previous frame, so
+	// everything on screen has to be redrawn regardless of the damage.
+	bool hasFrameViewChanged() const { return _frameViewChanged; }
+
+	// Calls fn(worldRect, color) for what covers area when drawn at zoom,
+	// back to front: LOD cells for components under minPixels across, then
+	// the rest one by one. For components that draw their rect in their color.
+	template <typename Fn>
+	void forEachDrawn(const SDL_Rect& area, double zoom, int minPixels, Fn&& fn)
+	{
+		int lodLevel = minPixels > 0 ? LodPyramid::getLevel(zoom, minPixels) : 0;
+		if (lodLevel > 0)
+		{
+			_lod.forEachCell(lodLevel, area, fn);
+		}
+
+		FrameVector<Uint32> ids(_frameArena);
+		_index.query(area, [&](Uint32 id) { ids.push_back(id); }, lodLevel);
+		std::sort(ids.begin(), ids.end());
+		for (Uint32 id : ids)
+		{
+			fn(_components[id]->getRect(), _components[id]->getColor());
+		}
+	}
+
+	// Draws the performance HUD over the components in render(). The HUD is
+	// created by the first render() that shows it, on the rendering thread.
+	void setHudVisible(bool visible) { _hudVisible = visible; }
+	bool isHudVisible() const { return _hudVisible; }
+	double getHudMilliseconds() const { return _hud ? _hud->getRenderMilliseconds() : 0.0; }
+
+	// Mutations are recorded to the journal from now on; pass nullptr to detach.
+	void setJournal(AutosaveJournal* journal) { _journal = journal; }
+
+	// Snap candidates are split across the job system once the spatial index
+	// returns at least this many of them; fewer are searched serially.
+	void setParallelSnapThreshold(size_t candidateCount) { _parallelSnapThreshold = candidateCount; }
+
+	// Performance counter ticks spent snapping since the previous call.
+	Uint64 takeSnapTicks()
+	{
+		Uint64 ticks = _snapTicks;
+		_snapTicks = 0;
+		return ticks;
+	}
+
 private:
+	void beginFrame();
+	void finishFrame();
+	void addDamage(const SDL_Rect& rect);
+	void invalidateView();
+	Uint32 pick(int x, int y);
+	void redrawIds(const SDL_Rect& screenRect);
+	Uint32 findHovered(const SDL_Point& point);
+	void beginSelectionBand(const SDL_Point& anchor, Uint32 toggle);
+	void moveSelectionBand(const SDL_Point& point);
+	void endSelectionBand();
+	void setSelectionBand(const SDL_Rect& band);
+	void refreshSelection(Uint32 id);
+	void setSelected(Uint32 id, bool selected);
+	void beginGroupDrag(const SDL_Point& grab);
+	void moveGroup(const SDL_Point& point);
+	void applyGroupDrag();
+	void endGroupDrag();
+	void setHovered(Uint32 id);
+	bool handleCameraEvent(const SDL_Event& event);
+	bool dispatch(size_t index, const SDL_Event& event);
+	void syncIndex(size_t index);
+	int getLodLevel() const;
+	void collectVisible(FrameVector<Uint32>& visible, int lodLevel) const;
+	void cullOccluded(FrameVector<Uint32>& visible);
+	bool isOccluded(const SDL_Rect& screenRect) const { return _occlusionCulling && _occlusion.isCovered(screenRect); }
+	void renderLod(int lodLevel);
+	// Pass GroupDrag as dragged to snap the selection as a whole.
+	static constexpr size_t GroupDrag = SIZE_MAX;
+	SnapResult snapDrag(const SDL_Rect& previous, SDL_Rect& rect, size_t dragged);
+	bool isSnapHeld(AlignmentIndex::Axis axis, const SDL_Rect& rect) const;
+	int getSnapAreas(const SDL_Rect& rect, SDL_Rect areas[4]) const;
+	void collectSnapCandidates(const SDL_Rect& rect, FrameVector<Uint32>& candidates) const;
+	SnapResult findSnap(const SDL_Rect& rect, size_t dragged);
+	bool findSweptSnap(const SDL_Rect& from, const SDL_Rect& rect, size_t dragged, SnapResult& snap);
+	static bool isSameSnap(const AxisSnap& snap, const AxisSnap& other)
+	{
+		return snap.isSet() && snap.target == other.target && snap.position == other.position;
+	}
+	SnapResult findSnap(const SDL_Rect& rect, size_t dragged, const Uint32* candidates, size_t count) const;
+	void offerAlignments(const SDL_Rect& rect, size_t dragged, SnapResult& snap);
+	void offerSpacing(const SDL_Rect& rect, size_t dragged, SnapResult& snap);
+	void addSpacingGuides(const SDL_Rect& rect);
+	void offerGrid(const SDL_Rect& rect, SnapResult& snap) const;
+	void updateGuides(const SDL_Rect& rect, const SnapResult& snap);
+	bool isSnapSkipped(size_t index, size_t dragged) const
+	{
+		return index == dragged || _components[index]->isDragging() || (dragged == GroupDrag && _selectionSlots[index] != NoSlot);
+	}
+	// Alignment and spacing only measure against components in view, so a
+	// rect does not jump to match something far off-screen and its guides
+	// stay on screen.
+	bool isGuideTargetSkipped(Uint32 id, size_t dragged, const SDL_Rect& visible) const
+	{
+		return !SDL_HasIntersection(&_alignment.getRect(id), &visible) || isSnapSkipped(id, dragged);
+	}
+
 	SDL_Renderer* _renderer;
 	std::vector<std::unique_ptr<GuiComponent>> _components;
+	std::vector<std::unique_ptr<GuiComponent>> _overlays;
+	AutosaveJournal* _journal = nullptr;
 	int _threshold{ 20 };
+	int _snapRelease{ 30 };
+
+	SpatialIndex _index;
+	AlignmentIndex _alignment;
+	bool _alignmentSnapping = true;
+	bool _spacingSnapping = true;
+	bool _sweptSnapping = false;
+	// A longer sweep takes bigger steps and may miss a zone.
+	static constexpr int MaxSweepSteps = 256;
+	// The snap each axis of the current drag holds on to, with its target's
+	// rect at the time, until the rect is pulled more than _snapRelease from
+	// it or the target moves. Dropped when the button is released.
+	size_t _heldDragged = 0;
+	AxisSnap _heldSnaps[AlignmentIndex::AxisCount];
+	SDL_Rect _heldTargets[AlignmentIndex::AxisCount]{};
+	// Where the pointer put the dragged rect before it was last snapped.
+	SDL_Rect _sweepFrom{};
+	bool _sweepTracked = false;
+	// The neighbors the last spacing snap measured along each axis, in
+	// order: beyond the one before, before, after, beyond the one after.
+	Uint32 _spacingNeighbors[AlignmentIndex::AxisCount][4];
+	// Target recorded for a snap to a grid line; loses ties to components.
+	static constexpr size_t GridTarget = AxisSnap::NoTarget - 1;
+	GridLayer _grid;
+	LodPyramid _lod;
+	int _lodPixels = 4;
+	OcclusionBuffer _occlusion;
+	bool _occlusionCulling = true;
+	Camera _camera;
+	int _viewportWidth = 0;
+	int _viewportHeight = 0;
+	bool _panning = false;
+
+	// Components that took the last button press and still get pointer
+	// events wherever the pointer goes.
+	std::vector<Uint32> _pointerCaptures;
+	SDL_Point _pointer{ 0, 0 };
+
+	// Declared before everything that allocates from it.
+	FrameArena _frameArena;
+	FrameVector<SDL_Rect> _damage;
+	FrameVector<SDL_Rect> _frameDamage;
+	bool _viewChanged = true;
+
+	// Picking buffer and the damage it has yet to catch up with. Past
+	// MaxIdDamage rects it is rebuilt instead.
+	static constexpr size_t MaxIdDamage = 256;
+	IdBuffer _ids;
+	bool _picking = false;
+	bool _idsValid = false;
+	std::vector<SDL_Rect> _idDamage;
+	bool _frameViewChanged = true;
+
+	// Hover tracking. _hoverRect is a world area around the pointer where
+	// _hoverHit stays the topmost component, so most motion costs a point in
+	// rect test. Past it the answer is worked out again from the components
+	// near the pointer, and only past _hoverArea, a HoverAreaPixels square
+	// when it was queried, or after damage inside it, is the index queried.
+	static constexpr int HoverAreaPixels = 32;
+	Uint32 _hovered = IdBuffer::NoId;
+	Uint32 _hoverHit = IdBuffer::NoId;
+	bool _hoverValid = false;
+	SDL_Rect _hoverArea{};
+	SDL_Rect _hoverRect{};
+	std::vector<Uint32> _hoverNeighbors;
+
+	// Selected ids in no particular order, and each component's position in
+	// that list. _band is the rubber band in world coordinates.
+	static constexpr Uint32 NoSlot = UINT32_MAX;
+	static constexpr SDL_Color BandColor = { 40, 120, 220, 255 };
+	std::vector<Uint32> _selection;
+	std::vector<Uint32> _selectionSlots;
+	SDL_Rect _band{};
+	SDL_Point _bandAnchor{};
+	Uint32 _bandToggle = IdBuffer::NoId;
+	bool _selecting = false;
+	bool _bandStarted = false;
+
+	// Group drag: the members and their rects when it began, the selection's
+	// bounds then, and the snapped offset from there that the last motion
+	// asked for and the one the members are at.
+	std::vector<Uint32> _groupIds;
+	std::vector<SDL_Rect> _groupOrigins;
+	SDL_Rect _groupBounds{};
+	SDL_Point _groupGrab{};
+	SDL_Point _groupOffset{};
+	SDL_Point _groupApplied{};
+	bool _groupDragging = false;
+
+	// World lines, with a zero width or height, for the alignments and equal
+	// gaps the last snap made; cleared when the button is released. Each axis
+	// has one alignment and up to four gaps.
+	static constexpr SDL_Color GuideColor = { 230, 40, 160, 255 };
+	static constexpr int MaxGuides = AlignmentIndex::AxisCount * 5;
+	SDL_Rect _guides[MaxGuides];
+	int _guideCount = 0;
+
+	size_t _parallelSnapThreshold{ 4096 };
+	Uint64 _snapTicks{ 0 };
+
+	// Consecutive rendered frames with a drag in progress; past the first few
+	// they are expected not to allocate.
+	static constexpr int SteadyDragFrames = 3;
+	bool _dragActive = false;
+	int _dragFrames = 0;
+	Uint64 _frameEndCounter = 0;
+
+	std::unique_ptr<PerformanceHud> _hud;
+	bool _hudVisible = false;
+	// SDL timestamp of the oldest consumed input not yet shown on screen.
+	Uint32 _pendingInputTimestamp = 0;
+
+	// Shared by the snap search and component updates, which never run at
+	// the same time.
+	JobSystem _jobs;
+	std::vector<size_t> _parallelUpdates;
+	std::vector<size_t> _serialUpdates;
 };
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <SDL2/SDL.h>
+
+// Screen-sized buffer holding, per pixel, the index of the topmost component
+// drawn there, so a hit test is a single lookup.
+class IdBuffer
+{
+public:
+	static constexpr Uint32 NoId = UINT32_MAX;
+
+	void reset(int width, int height)
+	{
+		_width = std::max(width, 0);
+		_height = std::max(height, 0);
+		_ids.assign(static_cast<size_t>(_width) * _height, NoId);
+	}
+
+	int getWidth() const { return _width; }
+	int getHeight() const { return _height; }
+
+	Uint32 get(int x, int y) const
+	{
+		if (x < 0 || y < 0 || x >= _width || y >= _height)
+		{
+			return NoId;
+		}
+		return _ids[static_cast<size_t>(y) * _width + x];
+	}
+
+	// Writes id over the part of rect that lies inside clip, which must be
+	// inside the buffer.
+	void fill(const SDL_Rect& rect, const SDL_Rect& clip, Uint32 id)
+	{
+		SDL_Rect clipped;
+		if (!SDL_IntersectRect(&rect, &clip, &clipped))
+		{
+			return;
+		}
+
+		for (int y = clipped.y; y < clipped.y + clipped.h; ++y)
+		{
+			Uint32* row = _ids.data() + static_cast<size_t>(y) * _width;
+			std::fill(row + clipped.x, row + clipped.x + clipped.w, id);
+		}
+	}
+
+private:
+	int _width = 0;
+	int _height = 0;
+	std::vector<Uint32> _ids;
+};
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "JobSystem.h"
+
+bool JobSystem::RangeDeque::pushBack(const Range& range)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_size == Capacity)
+	{
+		return false;
+	}
+
+	_ranges[(_front + _size) % Capacity] = range;
+	++_size;
+	return true;
+}
+
+bool JobSystem::RangeDeque::popBack(Range& range)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_size == 0)
+	{
+		return false;
+	}
+
+	--_size;
+	range = _ranges[(_front + _size) % Capacity];
+	return true;
+}
+
+bool JobSystem::RangeDeque::stealFront(Range& range)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_size == 0)
+	{
+		return false;
+	}
+
+	range = _ranges[_front];
+	_front = (_front + 1) % Capacity;
+	--_size;
+	return true;
+}
+
+size_t JobSystem::defaultWorkerCount()
+{
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+JobSystem::JobSystem(size_t workerCount)
+	: _workerCount(workerCount), _deques(new RangeDeque[workerCount + 1])
+{
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_start.notify_all();
+
+	for (auto& worker : _workers)
+	{
+		worker.join();
+	}
+}
+
+void JobSystem::startWorkers()
+{
+	// Workers wait for the generation to move on from 0, which the loop about
+	// to be published does.
+	_workers.reserve(_workerCount);
+	for (size_t i = 0; i < _workerCount; ++i)
+	{
+		// Thread 0 is whoever calls parallelFor.
+		_workers.emplace_back(&JobSystem::workerLoop, this, i + 1);
+	}
+}
+
+void JobSystem::run(size_t count, size_t grainSize, void* context, RangeFn fn)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	grainSize = grainSize > 0 ? grainSize : 1;
+	if (_workerCount == 0 || count <= grainSize)
+	{
+		for (size_t begin = 0; begin < count; begin += grainSize)
+		{
+			fn(context, begin, begin + grainSize < count ? begin + grainSize : count);
+		}
+		return;
+	}
+
+	if (_workers.empty())
+	{
+		startWorkers();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_context = context;
+		_fn = fn;
+		_grainSize = grainSize;
+		_remaining.store(count, std::memory_order_relaxed);
+		_busyWorkers = _workers.size();
+		++_generation;
+	}
+	_deques[0].pushBack({ 0, count });
+	_start.notify_all();
+
+	work(0);
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_done.wait(lock, [this] { return _busyWorkers == 0; });
+}
+
+void JobSystem::work(size_t thread)
+{
+	Range range;
+	while (_remaining.load(std::memory_order_acquire) > 0)
+	{
+		if (findRange(thread, range))
+		{
+			execute(thread, range);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::execute(size_t thread, Range range)
+{
+	while (range.end - range.begin > _grainSize)
+	{
+		size_t middle = range.begin + (range.end - range.begin) / 2;
+		if (!_deques[thread].pushBack({ middle, range.end }))
+		{
+			break;
+		}
+		range.end = middle;
+	}
+
+	for (size_t begin = range.begin; begin < range.end; begin += _grainSize)
+	{
+		_fn(_context, begin, begin + _grainSize < range.end ? begin + _grainSize : range.end);
+	}
+
+	_remaining.fetch_sub(range.end - range.begin, std::memory_order_acq_rel);
+}
+
+bool JobSystem::findRange(size_t thread, Range& range)
+{
+	if (_deques[thread].popBack(range))
+	{
+		return true;
+	}
+
+	size_t threadCount = getThreadCount();
+	for (size_t offset = 1; offset < threadCount; ++offset)
+	{
+		if (_deques[(thread + offset) % threadCount].stealFront(range))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::workerLoop(size_t thread)
+{
+	size_t seenGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_start.wait(lock, [&] { return _stopping || _generation != seenGeneration; });
+			if (_stopping)
+			{
+				return;
+			}
+			seenGeneration = _generation;
+		}
+
+		work(thread);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (--_busyWorkers == 0)
+		{
+			_done.notify_one();
+		}
+	}
+}
\ No newline at end of file
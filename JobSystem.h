@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Work-stealing scheduler for irregular data-parallel loops. Every thread owns
+// a deque of index ranges: it splits ranges in half, keeps working on the
+// front half and pushes the back half onto its own deque, while idle threads
+// steal the largest pending ranges from the other end of someone else's deque.
+// The workers are only started by the first loop with more than one range, so
+// a job system that never gets real work costs no threads.
+// parallelFor must only be called from one thread at a time.
+class JobSystem
+{
+public:
+	explicit JobSystem(size_t workerCount);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Counts the workers whether or not they have been started yet.
+	size_t getThreadCount() const { return _workerCount + 1; }
+
+	// One worker per additional hardware thread.
+	static size_t defaultWorkerCount();
+
+	// Calls fn(begin, end) over disjoint ranges covering [0, count), none
+	// larger than grainSize. Returns when the whole range has been processed.
+	template <typename Fn>
+	void parallelFor(size_t count, size_t grainSize, Fn&& fn)
+	{
+		using Callable = std::remove_reference_t<Fn>;
+		run(count, grainSize, const_cast<void*>(static_cast<const void*>(&fn)),
+			[](void* context, size_t begin, size_t end)
+			{
+				(*static_cast<Callable*>(context))(begin, end);
+			});
+	}
+
+private:
+	using RangeFn = void (*)(void*, size_t, size_t);
+
+	struct Range
+	{
+		size_t begin;
+		size_t end;
+	};
+
+	// Fixed-size deque: ranges are halved on every push, so a loop never
+	// needs more entries than there are bits in size_t.
+	class RangeDeque
+	{
+	public:
+		bool pushBack(const Range& range);
+		bool popBack(Range& range);
+		bool stealFront(Range& range);
+
+	private:
+		static constexpr size_t Capacity = 64;
+
+		std::mutex _mutex;
+		Range _ranges[Capacity];
+		size_t _front = 0;
+		size_t _size = 0;
+	};
+
+	void startWorkers();
+	void run(size_t count, size_t grainSize, void* context, RangeFn fn);
+	void work(size_t thread);
+	void execute(size_t thread, Range range);
+	bool findRange(size_t thread, Range& range);
+	void workerLoop(size_t thread);
+
+	size_t _workerCount;
+	std::vector<std::thread> _workers;
+	std::unique_ptr<RangeDeque[]> _deques;
+
+	std::mutex _mutex;
+	std::condition_variable _start;
+	std::condition_variable _done;
+	size_t _generation = 0;
+	size_t _busyWorkers = 0;
+	bool _stopping = false;
+
+	// Current loop, published to the workers under _mutex.
+	void* _context = nullptr;
+	RangeFn _fn = nullptr;
+	size_t _grainSize = 1;
+	std::atomic<size_t> _remaining{ 0 };
+};
\ No newline at end of file
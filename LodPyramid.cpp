@@ -0,0 +1,73 @@
+#include "LodPyramid.h"
+
+#include <algorithm>
+
+int LodPyramid::getLevel(double zoom, int minPixels)
+{
+	int level = 0;
+	while (level < SpatialIndex::LevelCount && SpatialIndex::getCellSize(level) * zoom < minPixels)
+	{
+		++level;
+	}
+	return level;
+}
+
+void LodPyramid::insert(Uint32 id, const SDL_Rect& rect, const SDL_Color& color)
+{
+	if (id >= _items.size())
+	{
+		_items.resize(id + 1);
+	}
+
+	_items[id] = { rect, color };
+	add(_items[id], false);
+}
+
+void LodPyramid::update(Uint32 id, const SDL_Rect& rect, const SDL_Color& color)
+{
+	Item& item = _items[id];
+	add(item, true);
+	item = { rect, color };
+	add(item, false);
+}
+
+void LodPyramid::add(const Item& item, bool remove)
+{
+	Uint64 area = static_cast<Uint64>(std::max(item.rect.w, 0)) * static_cast<Uint64>(std::max(item.rect.h, 0));
+	int centerX = item.rect.x + item.rect.w / 2;
+	int centerY = item.rect.y + item.rect.h / 2;
+
+	for (int level = SpatialIndex::getLevel(item.rect) + 1; level < LevelCount; ++level)
+	{
+		int size = SpatialIndex::getCellSize(level);
+		Cell& cell = _levels[level][_levels[level].findOrAdd(SpatialIndex::floorDiv(centerX, size), SpatialIndex::floorDiv(centerY, size))];
+		if (remove)
+		{
+			cell.red -= area * item.color.r;
+			cell.green -= area * item.color.g;
+			cell.blue -= area * item.color.b;
+			cell.area -= area;
+		}
+		else
+		{
+			cell.red += area * item.color.r;
+			cell.green += area * item.color.g;
+			cell.blue += area * item.color.b;
+			cell.area += area;
+		}
+	}
+}
+
+SDL_Color LodPyramid::getCellColor(const Cell& cell, int size)
+{
+	// Overlapping components can add up to more than the cell.
+	Uint64 cellArea = static_cast<Uint64>(size) * static_cast<Uint64>(size);
+	Uint64 covered = std::min(cell.area, cellArea);
+
+	auto blend = [&](Uint64 sum)
+		{
+			Uint64 average = sum / cell.area;
+			return static_cast<Uint8>(255 - (255 - average) * covered / cellArea);
+		};
+	return { blend(cell.red), blend(cell.green), blend(cell.blue), 255 };
+}
\ No newline at end of file
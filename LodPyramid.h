@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "GridHash.h"
+#include "SpatialIndex.h"
+
+// Coarse stand-ins for components too small to be worth drawing one by one.
+// Level L has the cell size of spatial index level L and sums, per cell, the
+// area-weighted color of every component from index levels below L whose
+// center lies in that cell. Moving or recoloring a component touches one cell
+// per level, so the pyramid is kept up to date as things change rather than
+// rebuilt per frame.
+class LodPyramid
+{
+public:
+	static constexpr int LevelCount = SpatialIndex::LevelCount + 1;
+
+	// Level to draw from at the given zoom: the components it stands in for
+	// would all be drawn less than minPixels across. 0 if there are none.
+	static int getLevel(double zoom, int minPixels);
+
+	void insert(Uint32 id, const SDL_Rect& rect, const SDL_Color& color);
+	void update(Uint32 id, const SDL_Rect& rect, const SDL_Color& color);
+
+	const SDL_Color& getColor(Uint32 id) const { return _items[id].color; }
+
+	// Calls fn(cellRect, color) for every occupied cell of level that overlaps
+	// area. The color is the cell's average blended over a white background
+	// by how much of the cell is covered, so cells can be drawn opaque.
+	template <typename Fn>
+	void forEachCell(int level, const SDL_Rect& area, Fn&& fn) const
+	{
+		const GridHash<Cell>& grid = _levels[level];
+		int size = SpatialIndex::getCellSize(level);
+		int left = SpatialIndex::floorDiv(area.x, size);
+		int top = SpatialIndex::floorDiv(area.y, size);
+		int right = SpatialIndex::floorDiv(area.x + area.w - 1, size);
+		int bottom = SpatialIndex::floorDiv(area.y + area.h - 1, size);
+
+		auto visitCell = [&](const Cell& cell)
+			{
+				if (cell.area > 0)
+				{
+					fn(SDL_Rect{ cell.x * size, cell.y * size, size, size }, getCellColor(cell, size));
+				}
+			};
+
+		Uint64 rangeCells = static_cast<Uint64>(right - left + 1) * static_cast<Uint64>(bottom - top + 1);
+		if (rangeCells <= grid.getCells().size())
+		{
+			for (int y = top; y <= bottom; ++y)
+			{
+				for (int x = left; x <= right; ++x)
+				{
+					Uint32 cell = grid.find(x, y);
+					if (cell != GridHash<Cell>::NoCell)
+					{
+						visitCell(grid[cell]);
+					}
+				}
+			}
+		}
+		else
+		{
+			for (const Cell& cell : grid.getCells())
+			{
+				if (cell.x >= left && cell.x <= right && cell.y >= top && cell.y <= bottom)
+				{
+					visitCell(cell);
+				}
+			}
+		}
+	}
+
+private:
+	struct Item
+	{
+		SDL_Rect rect;
+		SDL_Color color;
+	};
+
+	struct Cell
+	{
+		int x = 0;
+		int y = 0;
+		Uint64 red = 0;
+		Uint64 green = 0;
+		Uint64 blue = 0;
+		Uint64 area = 0;
+	};
+
+	static SDL_Color getCellColor(const Cell& cell, int size);
+
+	void add(const Item& item, bool remove);
+
+	std::vector<Item> _items;
+	GridHash<Cell> _levels[LevelCount];
+};
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+static const size_t MetricCount = static_cast<size_t>(Metric::Count);
+
+static const char* const metricNames[MetricCount] = {
+	"events_dispatched",
+	"events_consumed",
+	"events_deferred",
+	"hover_queries",
+	"snap_pairs_tested",
+	"snaps_applied",
+	"snaps_held",
+	"components_drawn",
+	"lod_cells_drawn",
+	"components_culled",
+	"draw_calls",
+	"damaged_pixels",
+	"frame_us",
+};
+
+struct MetricsRegistry
+{
+	std::mutex mutex;
+	std::vector<const std::atomic<Uint64>*> blocks;
+
+	// Counts of threads that have exited, so totals never go backwards.
+	MetricValues retired;
+
+	MetricValues totals;
+	MetricValues lastFrame;
+	Uint64 frameCount = 0;
+
+	std::FILE* dumpFile = nullptr;
+	Uint32 dumpInterval = 1000;
+	Uint32 lastDumpTicks = 0;
+	MetricValues dumpStart;
+	Uint64 dumpStartFrame = 0;
+};
+
+// Never destroyed, so threads that outlive static destruction can still
+// unregister safely.
+static MetricsRegistry& registry()
+{
+	static MetricsRegistry* instance = new MetricsRegistry;
+	return *instance;
+}
+
+Metrics::ThreadBlock::ThreadBlock()
+{
+	MetricsRegistry& shared = registry();
+	std::lock_guard<std::mutex> lock(shared.mutex);
+	shared.blocks.push_back(counters);
+}
+
+Metrics::ThreadBlock::~ThreadBlock()
+{
+	MetricsRegistry& shared = registry();
+	std::lock_guard<std::mutex> lock(shared.mutex);
+	for (size_t i = 0; i < MetricCount; ++i)
+	{
+		shared.retired.values[i] += counters[i].load(std::memory_order_relaxed);
+	}
+	shared.blocks.erase(std::remove(shared.blocks.begin(), shared.blocks.end(), counters), shared.blocks.end());
+}
+
+void Metrics::publishFrame()
+{
+	// Register this thread before taking the lock.
+	threadBlock();
+
+	MetricsRegistry& shared = registry();
+	std::lock_guard<std::mutex> lock(shared.mutex);
+
+	MetricValues totals = shared.retired;
+	for (const std::atomic<Uint64>* block : shared.blocks)
+	{
+		for (size_t i = 0; i < MetricCount; ++i)
+		{
+			totals.values[i] += block[i].load(std::memory_order_relaxed);
+		}
+	}
+
+	for (size_t i = 0; i < MetricCount; ++i)
+	{
+		shared.lastFrame.values[i] = totals.values[i] - shared.totals.values[i];
+	}
+	shared.totals = totals;
+	++shared.frameCount;
+
+	if (!shared.dumpFile)
+	{
+		return;
+	}
+
+	Uint32 now = SDL_GetTicks();
+	if (now - shared.lastDumpTicks < shared.dumpInterval)
+	{
+		return;
+	}
+
+	std::fprintf(shared.dumpFile, "metrics frame=%llu frames=%llu", static_cast<unsigned long long>(shared.frameCount),
+		static_cast<unsigned long long>(shared.frameCount - shared.dumpStartFrame));
+	for (size_t i = 0; i < MetricCount; ++i)
+	{
+		std::fprintf(shared.dumpFile, " %s=%llu", metricNames[i],
+			static_cast<unsigned long long>(totals.values[i] - shared.dumpStart.values[i]));
+	}
+	std::fprintf(shared.dumpFile, "\n");
+	std::fflush(shared.dumpFile);
+
+	shared.lastDumpTicks = now;
+	shared.dumpStart = totals;
+	shared.dumpStartFrame = shared.frameCount;
+}
+
+MetricValues Metrics::getLastFrame()
+{
+	MetricsRegistry& shared = registry();
+	std::lock_guard<std::mutex> lock(shared.mutex);
+	return shared.lastFrame;
+}
+
+MetricValues Metrics::getTotals()
+{
+	MetricsRegistry& shared = registry();
+	std::lock_guard<std::mutex> lock(shared.mutex);
+	return shared.totals;
+}
+
+Uint64 Metrics::getFrameCount()
+{
+	MetricsRegistry& shared = registry();
+	std::lock_guard<std::mutex> lock(shared.mutex);
+	return shared.frameCount;
+}
+
+const char* Metrics::getName(Metric metric)
+{
+	return metricNames[static_cast<size_t>(metric)];
+}
+
+void Metrics::setDumpFile(std::FILE* file, Uint32 intervalMilliseconds)
+{
+	MetricsRegistry& shared = registry();
+	std::lock_guard<std::mutex> lock(shared.mutex);
+	shared.dumpFile = file;
+	shared.dumpInterval = intervalMilliseconds;
+	shared.lastDumpTicks = SDL_GetTicks();
+	shared.dumpStart = shared.totals;
+	shared.dumpStartFrame = shared.frameCount;
+}
\ No newline at end of file
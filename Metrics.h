@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <SDL2/SDL.h>
+
+enum class Metric
+{
+	EventsDispatched,
+	EventsConsumed,
+	EventsDeferred,
+	HoverQueries,
+	SnapPairsTested,
+	SnapsApplied,
+	SnapsHeld,
+	ComponentsDrawn,
+	LodCellsDrawn,
+	ComponentsCulled,
+	DrawCalls,
+	DamagedPixels,
+	FrameMicroseconds,
+	Count
+};
+
+struct MetricValues
+{
+	Uint64 values[static_cast<size_t>(Metric::Count)] = {};
+
+	Uint64 operator[](Metric metric) const { return values[static_cast<size_t>(metric)]; }
+};
+
+// Process-wide counters for the controller's internals. Each thread adds to
+// its own block without atomic read-modify-writes or locks; publishFrame()
+// sums the blocks once per frame, so the pull API and the dump only ever see
+// whole frames.
+class Metrics
+{
+public:
+	static void add(Metric metric, Uint64 amount = 1)
+	{
+		std::atomic<Uint64>& counter = threadBlock().counters[static_cast<size_t>(metric)];
+		// Only this thread writes its block, so a plain load and store suffice.
+		counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+
+	// Closes the current frame; called by GuiController once per rendered frame.
+	static void publishFrame();
+
+	static MetricValues getLastFrame();
+	static MetricValues getTotals();
+	static Uint64 getFrameCount();
+
+	static const char* getName(Metric metric);
+
+	// Writes one line per interval with the sums over the frames it covers:
+	//   metrics frame=120 frames=60 events_dispatched=240 ...
+	// Pass stdout, or a file that stays open; nullptr stops dumping.
+	static void setDumpFile(std::FILE* file, Uint32 intervalMilliseconds = 1000);
+
+private:
+	struct ThreadBlock
+	{
+		ThreadBlock();
+		~ThreadBlock();
+
+		std::atomic<Uint64> counters[static_cast<size_t>(Metric::Count)] = {};
+	};
+
+	static ThreadBlock& threadBlock()
+	{
+		static thread_local ThreadBlock block;
+		return block;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "Minimap.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Metrics.h"
+
+Minimap::Minimap(SDL_Renderer* renderer, GuiController& controller, const SDL_Rect& rect, const SDL_Rect& worldBounds)
+	: GuiComponent(rect, { 96, 96, 96, 255 }), _renderer(renderer), _controller(controller),
+	_rightOffset(controller.getViewportWidth() - rect.x)
+{
+	setWorldBounds(worldBounds);
+}
+
+Minimap::~Minimap()
+{
+	if (_texture)
+	{
+		SDL_DestroyTexture(_texture);
+	}
+}
+
+void Minimap::setWorldBounds(const SDL_Rect& worldBounds)
+{
+	// One scale for both axes; the texture keeps the bounds' aspect ratio
+	// and fits inside rect.
+	const SDL_Rect& rect = getRect();
+	_worldBounds = worldBounds;
+	_mapping.x = worldBounds.x;
+	_mapping.y = worldBounds.y;
+	_mapping.zoom = std::min(static_cast<double>(rect.w) / std::max(worldBounds.w, 1),
+		static_cast<double>(rect.h) / std::max(worldBounds.h, 1));
+
+	int width = std::clamp(static_cast<int>(std::ceil(worldBounds.w * _mapping.zoom)), 1, std::max(rect.w, 1));
+	int height = std::clamp(static_cast<int>(std::ceil(worldBounds.h * _mapping.zoom)), 1, std::max(rect.h, 1));
+	if (_texture && (width != _textureWidth || height != _textureHeight))
+	{
+		SDL_DestroyTexture(_texture);
+		_texture = nullptr;
+	}
+	_textureWidth = width;
+	_textureHeight = height;
+	_fullRedraw = true;
+}
+
+bool Minimap::containsPoint(int x, int y) const
+{
+	SDL_Point point = { x, y };
+	SDL_Rect shown = { getRect().x, getRect().y, _textureWidth, _textureHeight };
+	return SDL_PointInRect(&point, &shown);
+}
+
+bool Minimap::handleEvent(const SDL_Event& event)
+{
+	if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+	{
+		// Left for the controller to resize its viewport as well.
+		getRect().x = event.window.data1 - _rightOffset;
+		return false;
+	}
+	else if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT &&
+		containsPoint(event.button.x, event.button.y))
+	{
+		_panning = true;
+		panTo(event.button.x, event.button.y);
+		return true;
+	}
+	else if (event.type == SDL_MOUSEMOTION && _panning)
+	{
+		panTo(event.motion.x, event.motion.y);
+		return true;
+	}
+	else if (event.type == SDL_MOUSEBUTTONUP && event.button.button == SDL_BUTTON_LEFT && _panning)
+	{
+		_panning = false;
+		return true;
+	}
+
+	return false;
+}
+
+void Minimap::panTo(int x, int y)
+{
+	// Center the view on the clicked point, keeping the zoom.
+	SDL_Point center = _mapping.toWorld(x - getRect().x, y - getRect().y);
+	SDL_Rect visible = _controller.getVisibleRect();
+	Camera camera = _controller.getCamera();
+	camera.x = center.x - visible.w / 2.0;
+	camera.y = center.y - visible.h / 2.0;
+	_controller.setCamera(camera);
+}
+
+void Minimap::redraw(SDL_Rect texels)
+{
+	SDL_Rect texture = { 0, 0, _textureWidth, _textureHeight };
+	if (!SDL_IntersectRect(&texels, &texture, &texels))
+	{
+		return;
+	}
+
+	void* pixels;
+	int pitch;
+	if (SDL_LockTexture(_texture, &texels, &pixels, &pitch) != 0)
+	{
+		return;
+	}
+
+	// Locked texels start out undefined, so every one of them is written:
+	// background first, then everything drawn over them back to front.
+	auto fill = [&](const SDL_Rect& area, const SDL_Color& color)
+		{
+			Uint32 argb = 0xFF000000u | (Uint32(color.r) << 16) | (Uint32(color.g) << 8) | color.b;
+			for (int y = area.y; y < area.y + area.h; ++y)
+			{
+				Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(pixels) + (y - texels.y) * pitch);
+				std::fill(row + (area.x - texels.x), row + (area.x - texels.x + area.w), argb);
+			}
+		};
+	fill(texels, { 255, 255, 255, 255 });
+
+	SDL_Rect world;
+	world.x = static_cast<int>(std::floor(_mapping.x + texels.x / _mapping.zoom));
+	world.y = static_cast<int>(std::floor(_mapping.y + texels.y / _mapping.zoom));
+	world.w = static_cast<int>(std::ceil(_mapping.x + (texels.x + texels.w) / _mapping.zoom)) - world.x;
+	world.h = static_cast<int>(std::ceil(_mapping.y + (texels.y + texels.h) / _mapping.zoom)) - world.y;
+
+	// Anything under a texel across comes from the LOD pyramid.
+	_controller.forEachDrawn(world, _mapping.zoom, 1, [&](const SDL_Rect& rect, const SDL_Color& color)
+		{
+			SDL_Rect mapped = _mapping.toScreen(rect);
+			SDL_Rect clipped;
+			if (SDL_IntersectRect(&mapped, &texels, &clipped))
+			{
+				fill(clipped, color);
+			}
+		});
+
+	SDL_UnlockTexture(_texture);
+}
+
+void Minimap::render(const Camera& camera)
+{
+	if (!_texture)
+	{
+		_texture = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, _textureWidth, _textureHeight);
+		if (!_texture)
+		{
+			return;
+		}
+		SDL_SetTextureBlendMode(_texture, SDL_BLENDMODE_NONE);
+		_fullRedraw = true;
+	}
+
+	const FrameVector<SDL_Rect>& damage = _controller.getFrameDamage();
+	if (_fullRedraw || damage.size() > MaxDamageRects)
+	{
+		redraw({ 0, 0, _textureWidth, _textureHeight });
+		_fullRedraw = false;
+	}
+	else
+	{
+		for (const SDL_Rect& rect : damage)
+		{
+			// A component too small to draw by itself shows up in a LOD cell
+			// that is at most two texels across and holds its center.
+			SDL_Rect texels = _mapping.toScreen(rect);
+			redraw({ texels.x - 2, texels.y - 2, texels.w + 4, texels.h + 4 });
+		}
+	}
+
+	SDL_Rect shown = camera.toScreen({ getRect().x, getRect().y, _textureWidth, _textureHeight });
+	SDL_RenderCopy(_renderer, _texture, nullptr, &shown);
+
+	// The part of the canvas on screen, clipped to the map.
+	SDL_Rect view = _mapping.toScreen(_controller.getVisibleRect());
+	view.x += shown.x;
+	view.y += shown.y;
+	const SDL_Color& color = getColor();
+	SDL_SetRenderDrawColor(_renderer, color.r, color.g, color.b, color.a);
+	SDL_RenderDrawRect(_renderer, &shown);
+	Metrics::add(Metric::DrawCalls, 2);
+	SDL_SetRenderDrawColor(_renderer, 220, 40, 40, 255);
+	if (SDL_IntersectRect(&view, &shown, &view))
+	{
+		SDL_RenderDrawRect(_renderer, &view);
+		Metrics::add(Metric::DrawCalls);
+	}
+}
+
+Minimap* Minimap::clone() const
+{
+	Minimap* copy = new Minimap(_renderer, _controller, getRect(), _worldBounds);
+	copy->setColor(getColor());
+	return copy;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include "GuiComponent.h"
+#include "GuiController.h"
+
+// Overview of a fixed area of the canvas with the current view outlined.
+// Clicking or dragging on it moves the view there.
+//
+// The picture lives in a low-resolution streaming texture. After the first
+// frame only the texels under the controller's frame damage are redrawn, from
+// the spatial index and the LOD pyramid, so a frame where nothing moved costs
+// a texture copy and two outlines.
+//
+// Meant to be added with GuiController::addOverlay; rect is in screen pixels.
+// It keeps its distance from the right edge of the viewport when the window is
+// resized.
+class Minimap : public GuiComponent
+{
+public:
+	Minimap(SDL_Renderer* renderer, GuiController& controller, const SDL_Rect& rect, const SDL_Rect& worldBounds);
+	~Minimap() override;
+
+	Minimap(const Minimap&) = delete;
+	Minimap& operator=(const Minimap&) = delete;
+
+	// Shows a different area of the canvas; redraws everything.
+	void setWorldBounds(const SDL_Rect& worldBounds);
+
+	bool handleEvent(const SDL_Event& event) override;
+	void render(const Camera& camera) override;
+	bool containsPoint(int x, int y) const override;
+	bool hasUpdate() const override { return false; }
+	Minimap* clone() const override;
+
+private:
+	// More damage than this in one frame and the whole picture is redrawn.
+	static constexpr size_t MaxDamageRects = 256;
+
+	void panTo(int x, int y);
+	void redraw(SDL_Rect texels);
+
+	SDL_Renderer* _renderer;
+	GuiController& _controller;
+	SDL_Rect _worldBounds;
+	// From the rect's left edge to the right edge of the viewport.
+	int _rightOffset;
+
+	// World to texel coordinates.
+	Camera _mapping;
+	int _textureWidth = 1;
+	int _textureHeight = 1;
+	SDL_Texture* _texture = nullptr;
+	bool _fullRedraw = true;
+	bool _panning = false;
+};
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "OcclusionBuffer.h"
+
+#include <algorithm>
+
+// Bits [begin, end) of a 64-bit word.
+static Uint64 bitRange(int begin, int end)
+{
+	Uint64 upTo = end >= 64 ? ~0ull : (1ull << end) - 1;
+	return upTo & ~((1ull << begin) - 1);
+}
+
+void OcclusionBuffer::reset(int width, int height)
+{
+	_width = std::max(width, 0);
+	_height = std::max(height, 0);
+	_tilesX = (_width + TileSize - 1) / TileSize;
+	_tilesY = (_height + TileSize - 1) / TileSize;
+	_wordsPerRow = (_tilesX + 63) / 64;
+	_bits.assign(static_cast<size_t>(_wordsPerRow) * _tilesY, 0);
+}
+
+bool OcclusionBuffer::clip(const SDL_Rect& rect, SDL_Rect& clipped) const
+{
+	SDL_Rect screen = { 0, 0, _width, _height };
+	return SDL_IntersectRect(&rect, &screen, &clipped) == SDL_TRUE;
+}
+
+bool OcclusionBuffer::isCovered(const SDL_Rect& rect) const
+{
+	SDL_Rect clipped;
+	if (!clip(rect, clipped))
+	{
+		return true;
+	}
+
+	// Every tile the rect touches has to be covered.
+	int left = clipped.x / TileSize;
+	int top = clipped.y / TileSize;
+	int right = (clipped.x + clipped.w + TileSize - 1) / TileSize;
+	int bottom = (clipped.y + clipped.h + TileSize - 1) / TileSize;
+	for (int tileY = top; tileY < bottom; ++tileY)
+	{
+		const Uint64* row = getRow(tileY);
+		for (int word = left / 64; word <= (right - 1) / 64; ++word)
+		{
+			Uint64 mask = bitRange(std::max(left - word * 64, 0), std::min(right - word * 64, 64));
+			if ((row[word] & mask) != mask)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void OcclusionBuffer::addOccluder(const SDL_Rect& rect)
+{
+	SDL_Rect clipped;
+	if (!clip(rect, clipped))
+	{
+		return;
+	}
+
+	// Only tiles entirely inside the rect. The last row and column may be
+	// cut short by the screen edge, in which case the edge counts as theirs.
+	int left = (clipped.x + TileSize - 1) / TileSize;
+	int top = (clipped.y + TileSize - 1) / TileSize;
+	int right = clipped.x + clipped.w == _width ? _tilesX : (clipped.x + clipped.w) / TileSize;
+	int bottom = clipped.y + clipped.h == _height ? _tilesY : (clipped.y + clipped.h) / TileSize;
+	if (left >= right)
+	{
+		return;
+	}
+
+	for (int tileY = top; tileY < bottom; ++tileY)
+	{
+		Uint64* row = getRow(tileY);
+		for (int word = left / 64; word <= (right - 1) / 64; ++word)
+		{
+			row[word] |= bitRange(std::max(left - word * 64, 0), std::min(right - word * 64, 64));
+		}
+	}
+}
\ No newline at end of file
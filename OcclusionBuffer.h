@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <SDL2/SDL.h>
+
+// Coarse record of which parts of the screen are already hidden behind opaque
+// rects, one bit per TileSize x TileSize tile. A tile is only marked once an
+// occluder covers all of it, so isCovered() never reports a pixel as hidden
+// that is not.
+class OcclusionBuffer
+{
+public:
+	static constexpr int TileSize = 8;
+
+	// Clears the buffer for a screen of the given size. Keeps its storage.
+	void reset(int width, int height);
+
+	// Screen rects; anything off screen counts as covered.
+	bool isCovered(const SDL_Rect& rect) const;
+	void addOccluder(const SDL_Rect& rect);
+
+private:
+	bool clip(const SDL_Rect& rect, SDL_Rect& clipped) const;
+	Uint64* getRow(int tileY) { return _bits.data() + static_cast<size_t>(tileY) * _wordsPerRow; }
+	const Uint64* getRow(int tileY) const { return _bits.data() + static_cast<size_t>(tileY) * _wordsPerRow; }
+
+	int _width = 0;
+	int _height = 0;
+	int _tilesX = 0;
+	int _tilesY = 0;
+	int _wordsPerRow = 0;
+	std::vector<Uint64> _bits;
+};
\ No newline at end of file
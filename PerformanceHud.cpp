@@ -0,0 +1,197 @@
+#include "PerformanceHud.h"
+
+#include <algorithm>
+#include <SDL2/SDL_test_font.h>
+
+#include "Metrics.h"
+
+// Printable ASCII, laid out 16 glyphs per row.
+static const int FirstGlyph = 32;
+static const int GlyphCount = 96;
+static const int AtlasColumns = 16;
+
+static const int Margin = 6;
+static const int GraphHeight = 40;
+static const float GraphScaleMs = 33.3f;
+static const float FrameBudgetMs = 16.7f;
+
+PerformanceHud::PerformanceHud(SDL_Renderer* renderer)
+	: _renderer(renderer)
+{
+	createGlyphAtlas();
+}
+
+PerformanceHud::~PerformanceHud()
+{
+	if (_glyphs)
+	{
+		SDL_DestroyTexture(_glyphs);
+	}
+}
+
+void PerformanceHud::createGlyphAtlas()
+{
+	// Draw every glyph once with the test font into a surface, through a
+	// software renderer, then upload the result as a single texture.
+	int rows = (GlyphCount + AtlasColumns - 1) / AtlasColumns;
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0,
+		AtlasColumns * FONT_CHARACTER_SIZE, rows * FONT_CHARACTER_SIZE, 32, SDL_PIXELFORMAT_ARGB8888);
+	if (!surface)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "HUD glyph atlas: %s", SDL_GetError());
+		return;
+	}
+
+	SDL_Renderer* software = SDL_CreateSoftwareRenderer(surface);
+	if (software)
+	{
+		SDL_SetRenderDrawBlendMode(software, SDL_BLENDMODE_NONE);
+		SDL_SetRenderDrawColor(software, 0, 0, 0, 0);
+		SDL_RenderClear(software);
+		SDL_SetRenderDrawColor(software, 255, 255, 255, 255);
+		for (int i = 0; i < GlyphCount; ++i)
+		{
+			SDLTest_DrawCharacter(software, (i % AtlasColumns) * FONT_CHARACTER_SIZE,
+				(i / AtlasColumns) * FONT_CHARACTER_SIZE, static_cast<Uint32>(FirstGlyph + i));
+		}
+		SDL_RenderFlush(software);
+
+		// The test font caches a texture per character for the renderer it was
+		// last used with; drop them before that renderer goes away.
+		SDLTest_CleanupTextDrawing();
+		SDL_DestroyRenderer(software);
+
+		_glyphs = SDL_CreateTextureFromSurface(_renderer, surface);
+		if (_glyphs)
+		{
+			SDL_SetTextureBlendMode(_glyphs, SDL_BLENDMODE_BLEND);
+		}
+	}
+
+	SDL_FreeSurface(surface);
+}
+
+void PerformanceHud::recordFrame(double milliseconds)
+{
+	_frameTimes[_frameCursor] = static_cast<float>(milliseconds);
+	_frameCursor = (_frameCursor + 1) % HistorySize;
+}
+
+void PerformanceHud::recordInputLatency(double milliseconds)
+{
+	_latencies[_latencyCursor] = static_cast<float>(milliseconds);
+	_latencyCursor = (_latencyCursor + 1) % LatencySamples;
+	_latencyCount = std::min(_latencyCount + 1, LatencySamples);
+}
+
+double PerformanceHud::latencyPercentile(double fraction) const
+{
+	if (_latencyCount == 0)
+	{
+		return 0.0;
+	}
+
+	float sorted[LatencySamples];
+	std::copy(_latencies, _latencies + _latencyCount, sorted);
+	int rank = std::max(1, static_cast<int>(fraction * _latencyCount + 0.999));
+	std::nth_element(sorted, sorted + rank - 1, sorted + _latencyCount);
+	return sorted[rank - 1];
+}
+
+void PerformanceHud::appendText(FrameVector<SDL_Vertex>& vertices, FrameVector<int>& indices, int x, int y, const char* text) const
+{
+	const float atlasWidth = static_cast<float>(AtlasColumns * FONT_CHARACTER_SIZE);
+	const float atlasHeight = static_cast<float>((GlyphCount + AtlasColumns - 1) / AtlasColumns * FONT_CHARACTER_SIZE);
+	const SDL_Color color = { 255, 255, 255, 255 };
+
+	for (; *text; ++text, x += FONT_CHARACTER_SIZE)
+	{
+		int glyph = static_cast<unsigned char>(*text) - FirstGlyph;
+		if (glyph <= 0 || glyph >= GlyphCount)
+		{
+			// Spaces and anything outside the atlas leave a gap.
+			continue;
+		}
+
+		float u0 = (glyph % AtlasColumns) * FONT_CHARACTER_SIZE / atlasWidth;
+		float v0 = (glyph / AtlasColumns) * FONT_CHARACTER_SIZE / atlasHeight;
+		float u1 = u0 + FONT_CHARACTER_SIZE / atlasWidth;
+		float v1 = v0 + FONT_CHARACTER_SIZE / atlasHeight;
+		float x0 = static_cast<float>(x);
+		float y0 = static_cast<float>(y);
+		float x1 = x0 + FONT_CHARACTER_SIZE;
+		float y1 = y0 + FONT_CHARACTER_SIZE;
+
+		int base = static_cast<int>(vertices.size());
+		vertices.push_back({ { x0, y0 }, color, { u0, v0 } });
+		vertices.push_back({ { x1, y0 }, color, { u1, v0 } });
+		vertices.push_back({ { x1, y1 }, color, { u1, v1 } });
+		vertices.push_back({ { x0, y1 }, color, { u0, v1 } });
+		for (int corner : { 0, 1, 2, 0, 2, 3 })
+		{
+			indices.push_back(base + corner);
+		}
+	}
+}
+
+void PerformanceHud::render(const HudStats& stats, FrameArena& arena)
+{
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	char lines[4][64];
+	SDL_snprintf(lines[0], sizeof(lines[0]), "frame %5.2f ms  hud %.3f ms",
+		_frameTimes[(_frameCursor + HistorySize - 1) % HistorySize], _renderMilliseconds);
+	SDL_snprintf(lines[1], sizeof(lines[1]), "input p50 %3.0f p90 %3.0f p99 %3.0f ms",
+		latencyPercentile(0.50), latencyPercentile(0.90), latencyPercentile(0.99));
+	SDL_snprintf(lines[2], sizeof(lines[2]), "components %llu  culled %llu",
+		static_cast<unsigned long long>(stats.componentCount), static_cast<unsigned long long>(stats.culledCount));
+	SDL_snprintf(lines[3], sizeof(lines[3]), "draw calls %llu", static_cast<unsigned long long>(stats.drawCalls));
+
+	const int lineCount = 4;
+	const int textWidth = 36 * FONT_CHARACTER_SIZE;
+	const int width = std::max(textWidth, HistorySize) + 2 * Margin;
+	const int graphTop = Margin + lineCount * FONT_LINE_HEIGHT + Margin;
+	const SDL_Rect panel = { 0, 0, width, graphTop + GraphHeight + Margin };
+
+	SDL_BlendMode previousBlend;
+	SDL_GetRenderDrawBlendMode(_renderer, &previousBlend);
+	SDL_SetRenderDrawBlendMode(_renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(_renderer, 0, 0, 0, 176);
+	SDL_RenderFillRect(_renderer, &panel);
+
+	// One bar per frame, oldest on the left; frames over budget in red.
+	FrameVector<SDL_Rect> withinBudget(arena);
+	FrameVector<SDL_Rect> overBudget(arena);
+	withinBudget.reserve(HistorySize);
+	overBudget.reserve(HistorySize);
+	for (int i = 0; i < HistorySize; ++i)
+	{
+		float milliseconds = _frameTimes[(_frameCursor + i) % HistorySize];
+		int height = std::min(GraphHeight, static_cast<int>(milliseconds / GraphScaleMs * GraphHeight + 0.5f));
+		SDL_Rect bar = { Margin + i, graphTop + GraphHeight - height, 1, height };
+		(milliseconds > FrameBudgetMs ? overBudget : withinBudget).push_back(bar);
+	}
+	SDL_SetRenderDrawColor(_renderer, 80, 220, 120, 255);
+	SDL_RenderFillRects(_renderer, withinBudget.data(), static_cast<int>(withinBudget.size()));
+	SDL_SetRenderDrawColor(_renderer, 240, 80, 80, 255);
+	SDL_RenderFillRects(_renderer, overBudget.data(), static_cast<int>(overBudget.size()));
+
+	if (_glyphs)
+	{
+		FrameVector<SDL_Vertex> vertices(arena);
+		FrameVector<int> indices(arena);
+		vertices.reserve(lineCount * 64 * 4);
+		indices.reserve(lineCount * 64 * 6);
+		for (int line = 0; line < lineCount; ++line)
+		{
+			appendText(vertices, indices, Margin, Margin + line * FONT_LINE_HEIGHT, lines[line]);
+		}
+		SDL_RenderGeometry(_renderer, _glyphs, vertices.data(), static_cast<int>(vertices.size()),
+			indices.data(), static_cast<int>(indices.size()));
+	}
+
+	SDL_SetRenderDrawBlendMode(_renderer, previousBlend);
+	Metrics::add(Metric::DrawCalls, _glyphs ? 4 : 3);
+
+	_renderMilliseconds = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include "FrameArena.h"
+
+struct HudStats
+{
+	size_t componentCount = 0;
+	Uint64 culledCount = 0;
+	Uint64 drawCalls = 0;
+};
+
+// Overlay in the top-left corner with a frame time graph, input latency
+// percentiles and a few counters. The SDL test font is rasterized once into a
+// glyph atlas texture, so a frame of the HUD costs one fill for the panel,
+// two for the graph and one geometry call for all of the text.
+class PerformanceHud
+{
+public:
+	explicit PerformanceHud(SDL_Renderer* renderer);
+	~PerformanceHud();
+
+	PerformanceHud(const PerformanceHud&) = delete;
+	PerformanceHud& operator=(const PerformanceHud&) = delete;
+
+	void recordFrame(double milliseconds);
+	void recordInputLatency(double milliseconds);
+
+	// Draws on top of whatever has been rendered so far. Scratch geometry comes
+	// from arena.
+	void render(const HudStats& stats, FrameArena& arena);
+
+	// Time the previous render() took, shown on the HUD itself.
+	double getRenderMilliseconds() const { return _renderMilliseconds; }
+
+private:
+	static constexpr int HistorySize = 120;
+	static constexpr int LatencySamples = 128;
+
+	void createGlyphAtlas();
+	void appendText(FrameVector<SDL_Vertex>& vertices, FrameVector<int>& indices, int x, int y, const char* text) const;
+	double latencyPercentile(double fraction) const;
+
+	SDL_Renderer* _renderer;
+	SDL_Texture* _glyphs = nullptr;
+
+	float _frameTimes[HistorySize] = {};
+	int _frameCursor = 0;
+
+	float _latencies[LatencySamples] = {};
+	int _latencyCount = 0;
+	int _latencyCursor = 0;
+
+	double _renderMilliseconds = 0.0;
+};
\ No newline at end of file
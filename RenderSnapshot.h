@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "Metrics.h"
+
+struct RenderItem
+{
+	SDL_Rect rect;
+	SDL_Color color;
+};
+
+// Everything needed to draw one frame, in back-to-front order. Once published
+// it is only read, so it can be rendered on another thread than the one that
+// built it.
+struct RenderSnapshot
+{
+	std::vector<RenderItem> items;
+};
+
+// Adds a one pixel outline just inside rect as four thin items.
+inline void appendOutline(RenderSnapshot& snapshot, const SDL_Rect& rect, const SDL_Color& color)
+{
+	if (rect.w <= 0 || rect.h <= 0)
+	{
+		return;
+	}
+
+	snapshot.items.push_back({ { rect.x, rect.y, rect.w, 1 }, color });
+	snapshot.items.push_back({ { rect.x, rect.y + rect.h - 1, rect.w, 1 }, color });
+	snapshot.items.push_back({ { rect.x, rect.y, 1, rect.h }, color });
+	snapshot.items.push_back({ { rect.x + rect.w - 1, rect.y, 1, rect.h }, color });
+}
+
+inline void renderSnapshot(SDL_Renderer* renderer, const RenderSnapshot& snapshot)
+{
+	SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+	SDL_RenderClear(renderer);
+
+	for (const RenderItem& item : snapshot.items)
+	{
+		SDL_SetRenderDrawColor(renderer, item.color.r, item.color.g, item.color.b, item.color.a);
+		SDL_RenderFillRect(renderer, &item.rect);
+	}
+	Metrics::add(Metric::DrawCalls, snapshot.items.size() + 1);
+
+	SDL_RenderPresent(renderer);
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <SDL2/SDL.h>
+
+#include "Enums.h"
+
+// Best snap found along one axis. Candidates are totally ordered by distance
+// and then by target index, so merging partial results in any order gives the
+// same answer as a single serial pass.
+struct AxisSnap
+{
+	static constexpr size_t NoTarget = SIZE_MAX;
+
+	int position = 0;
+	int distance = INT_MAX;
+	size_t target = NoTarget;
+
+	bool isSet() const { return target != NoTarget; }
+
+	void offer(int candidatePosition, int candidateDistance, size_t candidateTarget)
+	{
+		if (candidateDistance < distance || (candidateDistance == distance && candidateTarget < target))
+		{
+			position = candidatePosition;
+			distance = candidateDistance;
+			target = candidateTarget;
+		}
+	}
+
+	void merge(const AxisSnap& other)
+	{
+		if (other.isSet())
+		{
+			offer(other.position, other.distance, other.target);
+		}
+	}
+};
+
+struct SnapResult
+{
+	AxisSnap x;
+	AxisSnap y;
+
+	// Records snapping the side of rect named by whichSideIsNear against other.
+	void offerEdge(RectSide side, const SDL_Rect& rect, const SDL_Rect& other, int distance, size_t target)
+	{
+		switch (side)
+		{
+		case RectSide::Left:
+			x.offer(other.x - rect.w, distance, target);
+			break;
+		case RectSide::Right:
+			x.offer(other.x + other.w, distance, target);
+			break;
+		case RectSide::Top:
+			y.offer(other.y - rect.h, distance, target);
+			break;
+		case RectSide::Bottom:
+			y.offer(other.y + other.h, distance, target);
+			break;
+		case RectSide::None:
+			break;
+		}
+	}
+
+	void merge(const SnapResult& other)
+	{
+		x.merge(other.x);
+		y.merge(other.y);
+	}
+
+	SDL_Rect apply(SDL_Rect rect) const
+	{
+		if (x.isSet())
+		{
+			rect.x = x.position;
+		}
+		if (y.isSet())
+		{
+			rect.y = y.position;
+		}
+		return rect;
+	}
+};
\ No newline at end of file
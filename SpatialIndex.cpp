@@ -0,0 +1,109 @@
+#include "SpatialIndex.h"
+
+#include <algorithm>
+
+void SpatialIndex::insert(Uint32 id, const SDL_Rect& rect)
+{
+	if (id >= _entries.size())
+	{
+		_entries.resize(id + 1);
+	}
+
+	_entries[id].rect = rect;
+	link(id);
+}
+
+void SpatialIndex::update(Uint32 id, const SDL_Rect& rect)
+{
+	Entry& entry = _entries[id];
+	const SDL_Rect previous = entry.rect;
+	entry.rect = rect;
+
+	// Most moves stay within the same cell of the same level.
+	Uint8 level = getLevel(rect);
+	if (level == entry.level)
+	{
+		if (level == OversizedLevel)
+		{
+			return;
+		}
+
+		int size = getCellSize(level);
+		if (floorDiv(rect.x + rect.w / 2, size) == floorDiv(previous.x + previous.w / 2, size) &&
+			floorDiv(rect.y + rect.h / 2, size) == floorDiv(previous.y + previous.h / 2, size))
+		{
+			return;
+		}
+	}
+
+	unlink(id);
+	link(id);
+}
+
+Uint8 SpatialIndex::getLevel(const SDL_Rect& rect)
+{
+	int extent = std::max(rect.w, rect.h);
+	for (int level = 0; level < LevelCount; ++level)
+	{
+		if (extent <= getCellSize(level))
+		{
+			return static_cast<Uint8>(level);
+		}
+	}
+	return OversizedLevel;
+}
+
+void SpatialIndex::link(Uint32 id)
+{
+	Entry& entry = _entries[id];
+	entry.level = getLevel(entry.rect);
+	entry.previous = NoEntry;
+
+	Uint32* head = &_oversizedHead;
+	if (entry.level != OversizedLevel)
+	{
+		Level& grid = _levels[entry.level];
+		int size = getCellSize(entry.level);
+		entry.cell = grid.cells.findOrAdd(floorDiv(entry.rect.x + entry.rect.w / 2, size), floorDiv(entry.rect.y + entry.rect.h / 2, size));
+
+		Cell& cell = grid.cells[entry.cell];
+		++cell.count;
+		++grid.itemCount;
+		head = &cell.head;
+	}
+
+	entry.next = *head;
+	if (*head != NoEntry)
+	{
+		_entries[*head].previous = id;
+	}
+	*head = id;
+}
+
+void SpatialIndex::unlink(Uint32 id)
+{
+	Entry& entry = _entries[id];
+
+	Uint32* head = &_oversizedHead;
+	if (entry.level != OversizedLevel)
+	{
+		Level& grid = _levels[entry.level];
+		Cell& cell = grid.cells[entry.cell];
+		--cell.count;
+		--grid.itemCount;
+		head = &cell.head;
+	}
+
+	if (entry.previous != NoEntry)
+	{
+		_entries[entry.previous].next = entry.next;
+	}
+	else
+	{
+		*head = entry.next;
+	}
+	if (entry.next != NoEntry)
+	{
+		_entries[entry.next].previous = entry.previous;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "GridHash.h"
+
+// Loose grid over component rects, in world coordinates, with one level per
+// power-of-two cell size. A rect lives at the finest level whose cells are at
+// least as large as the rect, in the cell that contains its center, so it
+// never reaches further than half a cell outside that cell. Rects larger than
+// the coarsest cell are kept in a separate list that every query scans.
+//
+// Each cell is an intrusive list threaded through the entries, so moving a
+// rect between cells is O(1) and never allocates. New cells are only created
+// the first time a level sees a rect in that part of the world.
+//
+// Ids are dense and assigned by the caller in insertion order.
+class SpatialIndex
+{
+public:
+	static constexpr int LevelCount = 10;
+	static constexpr int FinestCellSize = 32;
+
+	static constexpr Uint8 OversizedLevel = LevelCount;
+
+	static int getCellSize(int level) { return FinestCellSize << level; }
+
+	// Finest level whose cells are at least as large as rect, or OversizedLevel.
+	static Uint8 getLevel(const SDL_Rect& rect);
+
+	static int floorDiv(int value, int divisor)
+	{
+		int quotient = value / divisor;
+		return quotient * divisor > value ? quotient - 1 : quotient;
+	}
+
+	void insert(Uint32 id, const SDL_Rect& rect);
+	void update(Uint32 id, const SDL_Rect& rect);
+
+	const SDL_Rect& getRect(Uint32 id) const { return _entries[id].rect; }
+	size_t size() const { return _entries.size(); }
+
+	// Calls fn(id) once for every rect that overlaps area, in no particular
+	// order. Rects below minLevel are left out.
+	template <typename Fn>
+	void query(const SDL_Rect& area, Fn&& fn, int minLevel = 0) const
+	{
+		for (int level = minLevel; level < LevelCount; ++level)
+		{
+			queryLevel(level, area, fn);
+		}
+
+		for (Uint32 id = _oversizedHead; id != NoEntry; id = _entries[id].next)
+		{
+			if (overlaps(_entries[id].rect, area))
+			{
+				fn(id);
+			}
+		}
+	}
+
+private:
+	static constexpr Uint32 NoEntry = UINT32_MAX;
+	static constexpr Uint32 NoCell = UINT32_MAX;
+
+	struct Entry
+	{
+		SDL_Rect rect;
+		Uint32 next = NoEntry;
+		Uint32 previous = NoEntry;
+		Uint32 cell = NoCell;
+		Uint8 level = OversizedLevel;
+	};
+
+	struct Cell
+	{
+		int x = 0;
+		int y = 0;
+		Uint32 head = NoEntry;
+		Uint32 count = 0;
+	};
+
+	struct Level
+	{
+		GridHash<Cell> cells;
+		size_t itemCount = 0;
+	};
+
+	// Empty rects count when they lie inside the area, so that snapping sees
+	// the same candidates as a full scan.
+	static bool overlaps(const SDL_Rect& rect, const SDL_Rect& area)
+	{
+		return rect.x < area.x + area.w && area.x < rect.x + rect.w &&
+			rect.y < area.y + area.h && area.y < rect.y + rect.h;
+	}
+
+	template <typename Fn>
+	void queryLevel(int level, const SDL_Rect& area, Fn& fn) const
+	{
+		const Level& grid = _levels[level];
+		if (grid.itemCount == 0)
+		{
+			return;
+		}
+
+		// Rects reach at most half a cell past the cell that holds them.
+		int size = getCellSize(level);
+		int half = size / 2;
+		int left = floorDiv(area.x - half, size);
+		int top = floorDiv(area.y - half, size);
+		int right = floorDiv(area.x + area.w + half, size);
+		int bottom = floorDiv(area.y + area.h + half, size);
+
+		auto visitCell = [&](const Cell& cell)
+			{
+				for (Uint32 id = cell.head; id != NoEntry; id = _entries[id].next)
+				{
+					if (overlaps(_entries[id].rect, area))
+					{
+						fn(id);
+					}
+				}
+			};
+
+		Uint64 rangeCells = static_cast<Uint64>(right - left + 1) * static_cast<Uint64>(bottom - top + 1);
+		if (rangeCells <= grid.cells.getCells().size())
+		{
+			for (int y = top; y <= bottom; ++y)
+			{
+				for (int x = left; x <= right; ++x)
+				{
+					Uint32 cell = grid.cells.find(x, y);
+					if (cell != NoCell)
+					{
+						visitCell(grid.cells[cell]);
+					}
+				}
+			}
+		}
+		else
+		{
+			// The area spans more cells than the level has; walk those instead.
+			for (const Cell& cell : grid.cells.getCells())
+			{
+				if (cell.count > 0 && cell.x >= left && cell.x <= right && cell.y >= top && cell.y <= bottom)
+				{
+					visitCell(cell);
+				}
+			}
+		}
+	}
+
+	void link(Uint32 id);
+	void unlink(Uint32 id);
+
+	std::vector<Entry> _entries;
+	Level _levels[LevelCount];
+	Uint32 _oversizedHead = NoEntry;
+};
\ No newline at end of file
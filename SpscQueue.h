@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// Capacity must be a power of two.
+template <typename T>
+class SpscQueue
+{
+public:
+	explicit SpscQueue(size_t capacity) : _items(capacity), _mask(capacity - 1) {}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	// Producer side. Returns false instead of waiting when the queue is full.
+	bool tryPush(const T& item)
+	{
+		T copy(item);
+		return tryPush(std::move(copy));
+	}
+
+	// Leaves the item untouched if the queue is full.
+	bool tryPush(T&& item)
+	{
+		size_t head = _head.load(std::memory_order_relaxed);
+		if (head - _cachedTail >= _items.size())
+		{
+			_cachedTail = _tail.load(std::memory_order_acquire);
+			if (head - _cachedTail >= _items.size())
+			{
+				return false;
+			}
+		}
+
+		_items[head & _mask] = std::move(item);
+		_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side.
+	bool tryPop(T& item)
+	{
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		if (tail == _cachedHead)
+		{
+			_cachedHead = _head.load(std::memory_order_acquire);
+			if (tail == _cachedHead)
+			{
+				return false;
+			}
+		}
+
+		item = std::move(_items[tail & _mask]);
+		_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	size_t capacity() const { return _items.size(); }
+
+private:
+	std::vector<T> _items;
+	size_t _mask;
+
+	// Producer and consumer indices live on separate cache lines, each next to
+	// the other side's cached copy it reads most often.
+	alignas(64) std::atomic<size_t> _head{ 0 };
+	size_t _cachedTail{ 0 };
+	alignas(64) std::atomic<size_t> _tail{ 0 };
+	size_t _cachedHead{ 0 };
+};
\ No newline at end of file
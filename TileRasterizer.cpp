@@ -0,0 +1,172 @@
+#include "TileRasterizer.h"
+
+#include "Metrics.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TILE_RASTERIZER_SSE2
+#endif
+
+static void fillSpan(Uint32* pixels, int count, Uint32 value)
+{
+#ifdef TILE_RASTERIZER_SSE2
+	__m128i packed = _mm_set1_epi32(static_cast<int>(value));
+	for (; count >= 16; count -= 16, pixels += 16)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), packed);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 4), packed);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 8), packed);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 12), packed);
+	}
+	for (; count >= 4; count -= 4, pixels += 4)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), packed);
+	}
+#endif
+	for (; count > 0; --count)
+	{
+		*pixels++ = value;
+	}
+}
+
+TileRasterizer::TileRasterizer(int width, int height, size_t workerCount)
+	: _surface(SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888)),
+	_tilesX((width + TileSize - 1) / TileSize),
+	_tilesY((height + TileSize - 1) / TileSize),
+	_bins(static_cast<size_t>(_tilesX) * _tilesY),
+	_background(SDL_MapRGBA(_surface->format, 255, 255, 255, 255)),
+	_jobs(workerCount)
+{
+}
+
+TileRasterizer::~TileRasterizer()
+{
+	if (_texture)
+	{
+		SDL_DestroyTexture(_texture);
+	}
+	SDL_FreeSurface(_surface);
+}
+
+void TileRasterizer::resize(int width, int height)
+{
+	if (width == _surface->w && height == _surface->h)
+	{
+		return;
+	}
+
+	SDL_FreeSurface(_surface);
+	_surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+	_tilesX = (width + TileSize - 1) / TileSize;
+	_tilesY = (height + TileSize - 1) / TileSize;
+	_bins.resize(static_cast<size_t>(_tilesX) * _tilesY);
+
+	// The next present() creates a texture of the new size.
+	if (_texture)
+	{
+		SDL_DestroyTexture(_texture);
+		_texture = nullptr;
+	}
+	_textureRenderer = nullptr;
+}
+
+void TileRasterizer::rasterize(const RenderSnapshot& snapshot)
+{
+	for (auto& bin : _bins)
+	{
+		bin.clear();
+	}
+
+	_pixels.resize(snapshot.items.size());
+
+	SDL_Rect bounds = { 0, 0, _surface->w, _surface->h };
+	for (size_t index = 0; index < snapshot.items.size(); ++index)
+	{
+		const RenderItem& item = snapshot.items[index];
+		_pixels[index] = SDL_MapRGBA(_surface->format, item.color.r, item.color.g, item.color.b, item.color.a);
+
+		SDL_Rect clipped;
+		if (!SDL_IntersectRect(&item.rect, &bounds, &clipped))
+		{
+			continue;
+		}
+
+		// Bins keep snapshot order, so every tile is still drawn back to front.
+		int firstX = clipped.x / TileSize;
+		int lastX = (clipped.x + clipped.w - 1) / TileSize;
+		int firstY = clipped.y / TileSize;
+		int lastY = (clipped.y + clipped.h - 1) / TileSize;
+		for (int tileY = firstY; tileY <= lastY; ++tileY)
+		{
+			for (int tileX = firstX; tileX <= lastX; ++tileX)
+			{
+				_bins[static_cast<size_t>(tileY) * _tilesX + tileX].push_back(static_cast<Uint32>(index));
+			}
+		}
+	}
+
+	_jobs.parallelFor(_bins.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t tile = begin; tile < end; ++tile)
+			{
+				rasterizeTile(snapshot, tile);
+			}
+		});
+}
+
+void TileRasterizer::rasterizeTile(const RenderSnapshot& snapshot, size_t tile)
+{
+	SDL_Rect tileRect = {
+		static_cast<int>(tile % _tilesX) * TileSize,
+		static_cast<int>(tile / _tilesX) * TileSize,
+		TileSize,
+		TileSize
+	};
+	tileRect.w = SDL_min(tileRect.w, _surface->w - tileRect.x);
+	tileRect.h = SDL_min(tileRect.h, _surface->h - tileRect.y);
+
+	auto* pixels = static_cast<Uint8*>(_surface->pixels);
+	auto fill = [&](const SDL_Rect& rect, Uint32 value)
+		{
+			for (int y = rect.y; y < rect.y + rect.h; ++y)
+			{
+				auto* row = reinterpret_cast<Uint32*>(pixels + static_cast<size_t>(y) * _surface->pitch);
+				fillSpan(row + rect.x, rect.w, value);
+			}
+		};
+
+	fill(tileRect, _background);
+
+	for (Uint32 index : _bins[tile])
+	{
+		SDL_Rect clipped;
+		if (SDL_IntersectRect(&snapshot.items[index].rect, &tileRect, &clipped))
+		{
+			fill(clipped, _pixels[index]);
+		}
+	}
+}
+
+void TileRasterizer::present(SDL_Renderer* renderer)
+{
+	if (_textureRenderer != renderer)
+	{
+		if (_texture)
+		{
+			SDL_DestroyTexture(_texture);
+		}
+		_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, _surface->w, _surface->h);
+		SDL_SetTextureBlendMode(_texture, SDL_BLENDMODE_NONE);
+		_textureRenderer = renderer;
+	}
+
+	SDL_UpdateTexture(_texture, nullptr, _surface->pixels, _surface->pitch);
+	SDL_RenderCopy(renderer, _texture, nullptr, nullptr);
+	Metrics::add(Metric::DrawCalls);
+	SDL_RenderPresent(renderer);
+}
+
+bool TileRasterizer::saveBMP(const char* path) const
+{
+	return SDL_SaveBMP(_surface, path) == 0;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "JobSystem.h"
+#include "RenderSnapshot.h"
+
+// CPU rasterizer for machines without a GPU. Each frame's rects are binned
+// into screen tiles, then the tiles are filled in parallel into an
+// ARGB8888 surface, which can be presented through a streaming texture or
+// written out. Output matches the SDL renderers drawing the same snapshot with
+// SDL_BLENDMODE_NONE.
+class TileRasterizer
+{
+public:
+	TileRasterizer(int width, int height, size_t workerCount);
+	~TileRasterizer();
+
+	TileRasterizer(const TileRasterizer&) = delete;
+	TileRasterizer& operator=(const TileRasterizer&) = delete;
+
+	void rasterize(const RenderSnapshot& snapshot);
+
+	// Reallocates the surface, tiles and texture for a new output size.
+	void resize(int width, int height);
+
+	SDL_Surface* getSurface() const { return _surface; }
+
+	// Uploads the surface to a streaming texture and presents it.
+	void present(SDL_Renderer* renderer);
+	bool saveBMP(const char* path) const;
+
+private:
+	static constexpr int TileSize = 64;
+
+	void rasterizeTile(const RenderSnapshot& snapshot, size_t tile);
+
+	SDL_Surface* _surface;
+	SDL_Texture* _texture = nullptr;
+	SDL_Renderer* _textureRenderer = nullptr;
+
+	int _tilesX;
+	int _tilesY;
+	std::vector<std::vector<Uint32>> _bins;
+	std::vector<Uint32> _pixels;
+	Uint32 _background;
+
+	JobSystem _jobs;
+};
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free handoff of whole values from one producer thread to one consumer
+// thread. The producer fills the write buffer and publishes it; the consumer
+// picks up the most recently published buffer. Neither side ever waits, and
+// frames published faster than they are consumed are skipped.
+template <typename T>
+class TripleBuffer
+{
+public:
+	// Producer side.
+	T& getWriteBuffer() { return _buffers[_writeIndex]; }
+
+	void publish()
+	{
+		unsigned int previous = _shared.exchange(_writeIndex | FreshBit, std::memory_order_acq_rel);
+		_writeIndex = previous & IndexMask;
+	}
+
+	// Consumer side. Returns true if a newer buffer than the current read
+	// buffer was published since the last call.
+	bool acquire()
+	{
+		if ((_shared.load(std::memory_order_relaxed) & FreshBit) == 0)
+		{
+			return false;
+		}
+
+		unsigned int previous = _shared.exchange(_readIndex, std::memory_order_acq_rel);
+		_readIndex = previous & IndexMask;
+		return true;
+	}
+
+	const T& getReadBuffer() const { return _buffers[_readIndex]; }
+
+private:
+	static constexpr unsigned int IndexMask = 3;
+	static constexpr unsigned int FreshBit = 4;
+
+	T _buffers[3];
+	unsigned int _writeIndex = 0;
+	unsigned int _readIndex = 1;
+	std::atomic<unsigned int> _shared{ 2 };
+};
\ No newline at end of file
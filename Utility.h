@@ -3,7 +3,9 @@
 #include <algorithm>
 #include <SDL2/SDL.h>
 
-bool isNear(const SDL_Rect& rect1, const SDL_Rect& rect2, int threshold)
+#include "Enums.h"
+
+inline bool isNear(const SDL_Rect& rect1, const SDL_Rect& rect2, int threshold)
 {
 	// Check if left side of rect1 is near the right side of rect2
 	if (abs(rect1.x - (rect2.x + rect2.w)) <= threshold &&
@@ -48,7 +50,46 @@ bool isNear(const SDL_Rect& rect1, const SDL_Rect& rect2, int threshold)
 	return false;
 }
 
-bool isDiagonal(const SDL_Rect& rect1, const SDL_Rect& rect2)
+// Writes the parts of rect outside hole as up to four disjoint rects and
+// returns how many there are.
+inline int subtractRect(const SDL_Rect& rect, const SDL_Rect& hole, SDL_Rect pieces[4])
+{
+	if (rect.w <= 0 || rect.h <= 0)
+	{
+		return 0;
+	}
+
+	SDL_Rect overlap;
+	if (!SDL_IntersectRect(&rect, &hole, &overlap))
+	{
+		pieces[0] = rect;
+		return 1;
+	}
+
+	// Full-width strips above and below the overlap, then the sides beside it.
+	int count = 0;
+	int right = rect.x + rect.w;
+	int bottom = rect.y + rect.h;
+	if (overlap.y > rect.y)
+	{
+		pieces[count++] = { rect.x, rect.y, rect.w, overlap.y - rect.y };
+	}
+	if (overlap.y + overlap.h < bottom)
+	{
+		pieces[count++] = { rect.x, overlap.y + overlap.h, rect.w, bottom - overlap.y - overlap.h };
+	}
+	if (overlap.x > rect.x)
+	{
+		pieces[count++] = { rect.x, overlap.y, overlap.x - rect.x, overlap.h };
+	}
+	if (overlap.x + overlap.w < right)
+	{
+		pieces[count++] = { overlap.x + overlap.w, overlap.y, right - overlap.x - overlap.w, overlap.h };
+	}
+	return count;
+}
+
+inline bool isDiagonal(const SDL_Rect& rect1, const SDL_Rect& rect2)
 {
 	// Check if the two rectangles overlap
 	if (SDL_HasIntersection(&rect1, &rect2)) {
@@ -71,7 +112,8 @@ bool isDiagonal(const SDL_Rect& rect1, const SDL_Rect& rect2)
 		(l1 > r2 && t1 > b2);
 }
 
-RectSide whichSideIsNear(const SDL_Rect& r1, const SDL_Rect& r2, int threshold)
+// Also reports the gap between the near sides through distance.
+inline RectSide whichSideIsNear(const SDL_Rect& r1, const SDL_Rect& r2, int threshold, int& distance)
 {
 	// Check if the rectangles overlap
 	bool near = isNear(r1, r2, threshold);
@@ -88,6 +130,8 @@ RectSide whichSideIsNear(const SDL_Rect& r1, const SDL_Rect& r2, int threshold)
 
 		if (minDistance <= threshold)
 		{
+			distance = minDistance;
+
 			if (minDistance == left) {
 				return RectSide::Left;
 			}
@@ -103,4 +147,10 @@ RectSide whichSideIsNear(const SDL_Rect& r1, const SDL_Rect& r2, int threshold)
 		}
 	}
 	return RectSide::None;
+}
+
+inline RectSide whichSideIsNear(const SDL_Rect& r1, const SDL_Rect& r2, int threshold)
+{
+	int distance;
+	return whichSideIsNear(r1, r2, threshold, distance);
 }
\ No newline at end of file
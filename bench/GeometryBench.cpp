@@ -0,0 +1,341 @@
+// Microbenchmarks for the geometry predicates in Utility.h, which run for
+// every candidate on every drag event.
+//
+// Usage: geometry-bench                      time each predicate per distribution (CSV)
+//        geometry-bench --check [N] [seed]   property-check every variant against
+//                                            the frozen reference implementations
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_test_fuzzer.h>
+
+#include "../Utility.h"
+#include "ReferenceGeometry.h"
+
+static const int Threshold = 20;
+
+struct RectPair
+{
+	SDL_Rect a;
+	SDL_Rect b;
+};
+
+// Implementations checked against the reference. Optimized versions of the
+// predicates get added here next to the ones from Utility.h.
+struct NearVariant
+{
+	const char* name;
+	bool (*fn)(const SDL_Rect&, const SDL_Rect&, int);
+};
+
+struct DiagonalVariant
+{
+	const char* name;
+	bool (*fn)(const SDL_Rect&, const SDL_Rect&);
+};
+
+struct SideVariant
+{
+	const char* name;
+	RectSide (*fn)(const SDL_Rect&, const SDL_Rect&, int);
+};
+
+static const NearVariant nearVariants[] = {
+	{ "isNear", isNear },
+};
+
+static const DiagonalVariant diagonalVariants[] = {
+	{ "isDiagonal", isDiagonal },
+};
+
+static const SideVariant sideVariants[] = {
+	{ "whichSideIsNear", [](const SDL_Rect& a, const SDL_Rect& b, int threshold) { return whichSideIsNear(a, b, threshold); } },
+	{ "whichSideIsNear(distance)", [](const SDL_Rect& a, const SDL_Rect& b, int threshold)
+		{
+			int distance = -1;
+			RectSide side = whichSideIsNear(a, b, threshold, distance);
+			// The reported distance must be within the threshold whenever a side is near.
+			return side != RectSide::None && (distance < 0 || distance > threshold) ? RectSide::None : side;
+		} },
+};
+
+static SDL_Rect randomRect(std::mt19937& random, int extent)
+{
+	std::uniform_int_distribution<int> position(0, extent);
+	std::uniform_int_distribution<int> size(10, 200);
+	return { position(random), position(random), size(random), size(random) };
+}
+
+// Places a next to one side of b, with a gap inside the threshold and
+// overlapping on the other axis.
+static SDL_Rect placeNear(const SDL_Rect& b, std::mt19937& random)
+{
+	std::uniform_int_distribution<int> gap(0, Threshold);
+	std::uniform_int_distribution<int> size(10, 200);
+	SDL_Rect a = { 0, 0, size(random), size(random) };
+	int slideX = b.x + static_cast<int>(random() % b.w) - a.w / 2;
+	int slideY = b.y + static_cast<int>(random() % b.h) - a.h / 2;
+
+	switch (random() % 4)
+	{
+	case 0:
+		a.x = b.x - a.w - gap(random);
+		a.y = slideY;
+		break;
+	case 1:
+		a.x = b.x + b.w + gap(random);
+		a.y = slideY;
+		break;
+	case 2:
+		a.x = slideX;
+		a.y = b.y - a.h - gap(random);
+		break;
+	default:
+		a.x = slideX;
+		a.y = b.y + b.h + gap(random);
+		break;
+	}
+	return a;
+}
+
+static std::vector<RectPair> randomPairs(size_t count, std::mt19937& random)
+{
+	std::vector<RectPair> pairs;
+	for (size_t i = 0; i < count; ++i)
+	{
+		pairs.push_back({ randomRect(random, 1000), randomRect(random, 1000) });
+	}
+	return pairs;
+}
+
+static std::vector<RectPair> allNearPairs(size_t count, std::mt19937& random)
+{
+	std::vector<RectPair> pairs;
+	for (size_t i = 0; i < count; ++i)
+	{
+		SDL_Rect b = randomRect(random, 1000);
+		pairs.push_back({ placeNear(b, random), b });
+	}
+	return pairs;
+}
+
+static std::vector<RectPair> noneNearPairs(size_t count, std::mt19937& random)
+{
+	std::vector<RectPair> pairs;
+	for (size_t i = 0; i < count; ++i)
+	{
+		SDL_Rect b = randomRect(random, 1000);
+		SDL_Rect a = randomRect(random, 1000);
+		a.x += 2000;
+		a.y += 2000;
+		pairs.push_back({ a, b });
+	}
+	return pairs;
+}
+
+static std::vector<RectPair> allDiagonalPairs(size_t count, std::mt19937& random)
+{
+	std::uniform_int_distribution<int> gap(1, Threshold);
+	std::vector<RectPair> pairs;
+	for (size_t i = 0; i < count; ++i)
+	{
+		SDL_Rect b = randomRect(random, 1000);
+		SDL_Rect a = randomRect(random, 1000);
+		a.x = random() % 2 ? b.x + b.w + gap(random) : b.x - a.w - gap(random);
+		a.y = random() % 2 ? b.y + b.h + gap(random) : b.y - a.h - gap(random);
+		pairs.push_back({ a, b });
+	}
+	return pairs;
+}
+
+// What a drag actually tests: one dragged rect against every other rect of a
+// clustered layout, for a handful of dragged rects.
+static std::vector<RectPair> realisticPairs(size_t count, std::mt19937& random)
+{
+	std::normal_distribution<double> spread(0.0, 120.0);
+	std::uniform_int_distribution<int> size(20, 120);
+	std::vector<SDL_Rect> scene;
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		int cluster = static_cast<int>(i % 6);
+		scene.push_back({ 300 + cluster * 250 + static_cast<int>(spread(random)),
+			400 + (cluster % 2) * 300 + static_cast<int>(spread(random)), size(random), size(random) });
+	}
+
+	std::vector<RectPair> pairs;
+	while (pairs.size() < count)
+	{
+		SDL_Rect dragged = scene[random() % scene.size()];
+		for (const SDL_Rect& other : scene)
+		{
+			pairs.push_back({ dragged, other });
+		}
+	}
+	pairs.resize(count);
+	return pairs;
+}
+
+template <typename Fn>
+static double nanosecondsPerCall(const std::vector<RectPair>& pairs, Fn&& fn)
+{
+	// Repeat until the measurement is long enough to be stable.
+	int sink = 0;
+	size_t calls = 0;
+	auto start = std::chrono::steady_clock::now();
+	std::chrono::duration<double, std::nano> elapsed{};
+	do
+	{
+		for (const RectPair& pair : pairs)
+		{
+			sink += fn(pair.a, pair.b);
+		}
+		calls += pairs.size();
+		elapsed = std::chrono::steady_clock::now() - start;
+	} while (elapsed.count() < 5e7);
+
+	volatile int keep = sink;
+	(void)keep;
+	return elapsed.count() / calls;
+}
+
+static int runBenchmarks()
+{
+	const size_t pairCount = 100000;
+	const struct { const char* name; std::vector<RectPair> (*generate)(size_t, std::mt19937&); } distributions[] = {
+		{ "random", randomPairs },
+		{ "all-near", allNearPairs },
+		{ "none-near", noneNearPairs },
+		{ "all-diagonal", allDiagonalPairs },
+		{ "realistic", realisticPairs },
+	};
+
+	std::printf("distribution,function,ns_per_call\n");
+	for (const auto& distribution : distributions)
+	{
+		std::mt19937 random(42);
+		std::vector<RectPair> pairs = distribution.generate(pairCount, random);
+
+		for (const NearVariant& variant : nearVariants)
+		{
+			std::printf("%s,%s,%.2f\n", distribution.name, variant.name, nanosecondsPerCall(pairs,
+				[&](const SDL_Rect& a, const SDL_Rect& b) { return static_cast<int>(variant.fn(a, b, Threshold)); }));
+		}
+		for (const DiagonalVariant& variant : diagonalVariants)
+		{
+			std::printf("%s,%s,%.2f\n", distribution.name, variant.name, nanosecondsPerCall(pairs,
+				[&](const SDL_Rect& a, const SDL_Rect& b) { return static_cast<int>(variant.fn(a, b)); }));
+		}
+		for (const SideVariant& variant : sideVariants)
+		{
+			std::printf("%s,%s,%.2f\n", distribution.name, variant.name, nanosecondsPerCall(pairs,
+				[&](const SDL_Rect& a, const SDL_Rect& b) { return static_cast<int>(variant.fn(a, b, Threshold)); }));
+		}
+	}
+
+	return 0;
+}
+
+static SDL_Rect fuzzRect()
+{
+	// Mix plain random values with values at and just past the edges of the
+	// range, where off-by-one mistakes in the comparisons show up.
+	auto coordinate = []
+		{
+			return SDLTest_RandomUint8() < 64
+				? SDLTest_RandomSint32BoundaryValue(-100, 100, SDL_TRUE)
+				: SDLTest_RandomIntegerInRange(-100, 100);
+		};
+	return { coordinate(), coordinate(), SDLTest_RandomIntegerInRange(0, 120), SDLTest_RandomIntegerInRange(0, 120) };
+}
+
+static bool reportFailure(const char* property, const RectPair& pair, int threshold)
+{
+	std::fprintf(stderr, "FAIL %s: a={%d,%d,%d,%d} b={%d,%d,%d,%d} threshold=%d\n", property,
+		pair.a.x, pair.a.y, pair.a.w, pair.a.h, pair.b.x, pair.b.y, pair.b.w, pair.b.h, threshold);
+	return false;
+}
+
+static bool checkPair(const RectPair& pair, int threshold)
+{
+	bool ok = true;
+
+	bool near = referenceIsNear(pair.a, pair.b, threshold);
+	for (const NearVariant& variant : nearVariants)
+	{
+		if (variant.fn(pair.a, pair.b, threshold) != near)
+		{
+			ok = reportFailure(variant.name, pair, threshold);
+		}
+	}
+
+	bool diagonal = referenceIsDiagonal(pair.a, pair.b);
+	for (const DiagonalVariant& variant : diagonalVariants)
+	{
+		if (variant.fn(pair.a, pair.b) != diagonal)
+		{
+			ok = reportFailure(variant.name, pair, threshold);
+		}
+	}
+	if (referenceIsDiagonal(pair.b, pair.a) != diagonal)
+	{
+		ok = reportFailure("isDiagonal is symmetric", pair, threshold);
+	}
+
+	RectSide side = referenceWhichSideIsNear(pair.a, pair.b, threshold);
+	for (const SideVariant& variant : sideVariants)
+	{
+		if (variant.fn(pair.a, pair.b, threshold) != side)
+		{
+			ok = reportFailure(variant.name, pair, threshold);
+		}
+	}
+	if (side != RectSide::None && (!near || diagonal))
+	{
+		ok = reportFailure("a near side implies isNear and not isDiagonal", pair, threshold);
+	}
+
+	return ok;
+}
+
+static int runChecks(int iterations, Uint64 seed)
+{
+	SDLTest_FuzzerInit(seed);
+
+	int failures = 0;
+	for (int i = 0; i < iterations && failures < 20; ++i)
+	{
+		int threshold = SDLTest_RandomIntegerInRange(0, 40);
+		RectPair pair = { fuzzRect(), fuzzRect() };
+
+		// Half of the cases move a next to b so the near branches get covered.
+		if (i % 2 == 0 && pair.b.w > 0 && pair.b.h > 0)
+		{
+			std::mt19937 random(static_cast<unsigned int>(SDLTest_RandomUint32()));
+			pair.a = placeNear(pair.b, random);
+		}
+
+		if (!checkPair(pair, threshold))
+		{
+			++failures;
+		}
+	}
+
+	std::printf("%d cases, seed %llu, %d failing\n", iterations, static_cast<unsigned long long>(seed), failures);
+	return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1 && SDL_strcmp(argv[1], "--check") == 0)
+	{
+		int iterations = argc > 2 ? std::atoi(argv[2]) : 1000000;
+		Uint64 seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1;
+		return runChecks(iterations, seed);
+	}
+
+	return runBenchmarks();
+}
\ No newline at end of file
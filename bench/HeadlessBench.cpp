@@ -0,0 +1,469 @@
+// Headless benchmark for GuiController. Builds a scene on SDL's offscreen (or
+// dummy) video driver with a software renderer, plays a scripted scenario and
+// prints per-frame percentiles as one JSON object on stdout.
+//
+// Usage: gui-bench [--scene uniform|clustered|tiled] [--count N]
+//                  [--scenario drag|spawn|pan|hover|select|group] [--frames N] [--width W] [--height H]
+//                  [--canvas-scale K] [--zoom Z] [--lod-pixels P] [--seed S]
+//                  [--hud 0|1] [--minimap 0|1] [--picking 0|1] [--grid SPACING]
+//                  [--swept 0|1]
+//
+// The scene covers K by K viewports; with a large K and count, the pan
+// scenario shows whether frame cost follows what is on screen. The hover
+// scenario moves the pointer without pressing anything, which is all hit
+// testing; the select scenario drags a rubber band from the canvas center,
+// and the group scenario drags everything in view as one selection.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "../AllocationTracker.h"
+#include "../DraggableRectangle.h"
+#include "../GuiController.h"
+#include "../Metrics.h"
+#include "../Minimap.h"
+
+#ifdef GUI_TRACK_ALLOCATIONS
+
+// The tracker in gui-core already replaces operator new.
+static size_t allocationsSoFar()
+{
+	return AllocationTracker::getTotalAllocations();
+}
+
+#else
+
+static std::atomic<size_t> allocationCount{ 0 };
+
+void* operator new(size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* pointer = std::malloc(size ? size : 1))
+	{
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	std::free(pointer);
+}
+
+static size_t allocationsSoFar()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+#endif
+
+struct Options
+{
+	std::string scene = "uniform";
+	std::string scenario = "drag";
+	size_t count = 1000;
+	int frames = 300;
+	int width = 1280;
+	int height = 720;
+	int canvasScale = 1;
+	double zoom = 1.0;
+	int lodPixels = 4;
+	unsigned int seed = 1;
+	bool hud = false;
+	bool minimap = false;
+	bool picking = false;
+	int grid = 0;
+	bool swept = false;
+};
+
+class Samples
+{
+public:
+	void reserve(size_t count) { _values.reserve(count); }
+	void add(double value) { _values.push_back(value); }
+
+	void print(const char* name, bool last = false)
+	{
+		std::sort(_values.begin(), _values.end());
+		double sum = 0.0;
+		for (double value : _values)
+		{
+			sum += value;
+		}
+
+		std::printf("  \"%s\": { \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f, \"mean\": %.4f }%s\n",
+			name, percentile(0.50), percentile(0.90), percentile(0.99), percentile(1.0),
+			_values.empty() ? 0.0 : sum / _values.size(), last ? "" : ",");
+	}
+
+private:
+	// Nearest-rank percentile of the sorted samples.
+	double percentile(double fraction) const
+	{
+		if (_values.empty())
+		{
+			return 0.0;
+		}
+		size_t rank = static_cast<size_t>(std::ceil(fraction * _values.size()));
+		return _values[rank > 0 ? rank - 1 : 0];
+	}
+
+	std::vector<double> _values;
+};
+
+static double toMilliseconds(Uint64 ticks)
+{
+	return ticks * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+static SDL_Color randomColor(std::mt19937& random)
+{
+	return { static_cast<Uint8>(random()), static_cast<Uint8>(random()), static_cast<Uint8>(random()), 255 };
+}
+
+static std::vector<SDL_Rect> generateScene(const Options& options, std::mt19937& random)
+{
+	std::vector<SDL_Rect> rects;
+	rects.reserve(options.count);
+
+	if (options.scene == "tiled")
+	{
+		// Square cells with a small gap, filling the canvas row by row.
+		int columns = static_cast<int>(std::ceil(std::sqrt(options.count * double(options.width) / options.height)));
+		int cell = std::max(2, options.width / std::max(1, columns));
+		for (size_t i = 0; i < options.count; ++i)
+		{
+			int column = static_cast<int>(i % columns);
+			int row = static_cast<int>(i / columns);
+			rects.push_back({ column * cell, row * cell, cell - 1, cell - 1 });
+		}
+	}
+	else if (options.scene == "clustered")
+	{
+		std::uniform_int_distribution<int> size(10, 60);
+		std::vector<SDL_Point> centers;
+		for (int i = 0; i < 8; ++i)
+		{
+			centers.push_back({ static_cast<int>(random() % options.width), static_cast<int>(random() % options.height) });
+		}
+
+		std::normal_distribution<double> spread(0.0, std::min(options.width, options.height) / 12.0);
+		for (size_t i = 0; i < options.count; ++i)
+		{
+			const SDL_Point& center = centers[i % centers.size()];
+			rects.push_back({ center.x + static_cast<int>(spread(random)), center.y + static_cast<int>(spread(random)),
+				size(random), size(random) });
+		}
+	}
+	else
+	{
+		std::uniform_int_distribution<int> size(10, 60);
+		for (size_t i = 0; i < options.count; ++i)
+		{
+			rects.push_back({ static_cast<int>(random() % options.width), static_cast<int>(random() % options.height),
+				size(random), size(random) });
+		}
+	}
+
+	return rects;
+}
+
+static SDL_Event mouseButtonEvent(Uint32 type, Uint8 button, int x, int y)
+{
+	SDL_Event event = {};
+	event.type = type;
+	event.button.button = button;
+	event.button.x = x;
+	event.button.y = y;
+	return event;
+}
+
+static SDL_Event mouseMotionEvent(int x, int y, int previousX, int previousY)
+{
+	SDL_Event event = {};
+	event.type = SDL_MOUSEMOTION;
+	event.motion.x = x;
+	event.motion.y = y;
+	event.motion.xrel = x - previousX;
+	event.motion.yrel = y - previousY;
+	return event;
+}
+
+static bool parseOptions(int argc, char* argv[], Options& options)
+{
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string name = argv[i];
+		const char* value = argv[i + 1];
+		if (name == "--scene")
+		{
+			options.scene = value;
+		}
+		else if (name == "--scenario")
+		{
+			options.scenario = value;
+		}
+		else if (name == "--count")
+		{
+			options.count = std::strtoul(value, nullptr, 10);
+		}
+		else if (name == "--frames")
+		{
+			options.frames = std::atoi(value);
+		}
+		else if (name == "--width")
+		{
+			options.width = std::atoi(value);
+		}
+		else if (name == "--height")
+		{
+			options.height = std::atoi(value);
+		}
+		else if (name == "--canvas-scale")
+		{
+			options.canvasScale = std::atoi(value);
+		}
+		else if (name == "--zoom")
+		{
+			options.zoom = std::atof(value);
+		}
+		else if (name == "--lod-pixels")
+		{
+			options.lodPixels = std::atoi(value);
+		}
+		else if (name == "--seed")
+		{
+			options.seed = static_cast<unsigned int>(std::strtoul(value, nullptr, 10));
+		}
+		else if (name == "--hud")
+		{
+			options.hud = std::atoi(value) != 0;
+		}
+		else if (name == "--minimap")
+		{
+			options.minimap = std::atoi(value) != 0;
+		}
+		else if (name == "--picking")
+		{
+			options.picking = std::atoi(value) != 0;
+		}
+		else if (name == "--grid")
+		{
+			options.grid = std::atoi(value);
+		}
+		else if (name == "--swept")
+		{
+			options.swept = std::atoi(value) != 0;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return (argc % 2) == 1 &&
+		(options.scene == "uniform" || options.scene == "clustered" || options.scene == "tiled") &&
+		(options.scenario == "drag" || options.scenario == "spawn" || options.scenario == "pan" ||
+			options.scenario == "hover" || options.scenario == "select" || options.scenario == "group") &&
+		options.frames > 0 && options.width > 0 && options.height > 0 && options.canvasScale > 0 &&
+		options.zoom >= Camera::MinZoom && options.zoom <= Camera::MaxZoom && options.lodPixels >= 0 && options.grid >= 0;
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::fprintf(stderr, "usage: gui-bench [--scene uniform|clustered|tiled] [--count N] "
+			"[--scenario drag|spawn|pan|hover|select|group] [--frames N] [--width W] [--height H] [--canvas-scale K] "
+			"[--zoom Z] [--lod-pixels P] [--seed S] [--hud 0|1] [--minimap 0|1] [--picking 0|1] [--grid SPACING] [--swept 0|1]\n");
+		return 2;
+	}
+
+	SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+	if (SDL_Init(SDL_INIT_VIDEO) != 0)
+	{
+		SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+		if (SDL_Init(SDL_INIT_VIDEO) != 0)
+		{
+			std::fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
+			return 1;
+		}
+	}
+
+	SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, options.width, options.height, 32, SDL_PIXELFORMAT_ARGB8888);
+	SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(target);
+
+	std::mt19937 random(options.seed);
+	MetricValues metricsBefore = {};
+	MetricValues metricsAfter = {};
+	Samples frameTimes, dispatchTimes, snapTimes, hudTimes, allocations;
+	for (Samples* samples : { &frameTimes, &dispatchTimes, &snapTimes, &hudTimes, &allocations })
+	{
+		// Keep the bench's own bookkeeping out of the per-frame allocation counts.
+		samples->reserve(options.frames);
+	}
+
+	{
+		GuiController controller(renderer);
+		controller.setHudVisible(options.hud);
+		controller.setLodThreshold(options.lodPixels);
+		controller.setPickingBuffer(options.picking);
+		controller.setGrid(options.grid, 4);
+		controller.setSweptSnapping(options.swept);
+		Camera camera;
+		camera.zoom = options.zoom;
+		controller.setCamera(camera);
+		Options canvas = options;
+		canvas.width *= options.canvasScale;
+		canvas.height *= options.canvasScale;
+		std::vector<SDL_Rect> scene = generateScene(canvas, random);
+		if (options.minimap)
+		{
+			controller.addOverlay(std::make_unique<Minimap>(renderer, controller,
+				SDL_Rect{ options.width - 210, 10, 200, 150 }, SDL_Rect{ 0, 0, canvas.width, canvas.height }));
+		}
+		for (const SDL_Rect& rect : scene)
+		{
+			controller.addComponent(std::make_unique<DraggableRectangle>(renderer, rect, randomColor(random)));
+		}
+
+		const int motionsPerFrame = 4;
+		const int spawnsPerFrame = 10;
+		int centerX = options.width / 2;
+		int centerY = options.height / 2;
+		int x = centerX;
+		int y = centerY;
+		if (options.scenario == "group")
+		{
+			// Band everything in view first.
+			SDL_SetModState(KMOD_SHIFT);
+			SDL_Event down = mouseButtonEvent(SDL_MOUSEBUTTONDOWN, SDL_BUTTON_LEFT, 0, 0);
+			SDL_Event motion = mouseMotionEvent(options.width - 1, options.height - 1, 0, 0);
+			SDL_Event up = mouseButtonEvent(SDL_MOUSEBUTTONUP, SDL_BUTTON_LEFT, options.width - 1, options.height - 1);
+			controller.handleEvent(down);
+			controller.handleEvent(motion);
+			controller.handleEvent(up);
+			SDL_SetModState(KMOD_NONE);
+		}
+		if ((options.scenario == "drag" || options.scenario == "group") && !scene.empty())
+		{
+			// Grab the last component added, which is on top, so the drag
+			// always hits something.
+			SDL_Rect grabbed = camera.toScreen(scene.back());
+			x = grabbed.x + grabbed.w / 2;
+			y = grabbed.y + grabbed.h / 2;
+			SDL_Event down = mouseButtonEvent(SDL_MOUSEBUTTONDOWN, SDL_BUTTON_LEFT, x, y);
+			controller.handleEvent(down);
+		}
+		else if (options.scenario == "select")
+		{
+			// With Shift held the drag bands even where it starts on a component.
+			SDL_SetModState(KMOD_SHIFT);
+			SDL_Event down = mouseButtonEvent(SDL_MOUSEBUTTONDOWN, SDL_BUTTON_LEFT, x, y);
+			controller.handleEvent(down);
+			SDL_SetModState(KMOD_NONE);
+		}
+		else if (options.scenario == "pan")
+		{
+			// Hold the middle button so the circling pointer drags the camera.
+			SDL_Event down = mouseButtonEvent(SDL_MOUSEBUTTONDOWN, SDL_BUTTON_MIDDLE, x, y);
+			controller.handleEvent(down);
+		}
+		controller.takeSnapTicks();
+		metricsBefore = Metrics::getTotals();
+
+		for (int frame = 0; frame < options.frames; ++frame)
+		{
+			size_t allocationsBefore = allocationsSoFar();
+			Uint64 frameStart = SDL_GetPerformanceCounter();
+			Uint64 dispatchTicks = 0;
+
+			if (options.scenario == "spawn")
+			{
+				for (int i = 0; i < spawnsPerFrame; ++i)
+				{
+					SDL_Rect rect = { static_cast<int>(random() % options.width), static_cast<int>(random() % options.height), 40, 40 };
+					controller.addComponent(std::make_unique<DraggableRectangle>(renderer, rect, randomColor(random)));
+				}
+			}
+
+			// The pointer circles the canvas center; without a drag the
+			// motion events still go through the full dispatch.
+			for (int i = 0; i < motionsPerFrame; ++i)
+			{
+				double angle = (frame * motionsPerFrame + i) * 0.02;
+				int nextX = centerX + static_cast<int>(std::cos(angle) * options.width / 3);
+				int nextY = centerY + static_cast<int>(std::sin(angle) * options.height / 3);
+				SDL_Event motion = mouseMotionEvent(nextX, nextY, x, y);
+				x = nextX;
+				y = nextY;
+
+				Uint64 dispatchStart = SDL_GetPerformanceCounter();
+				controller.handleEvent(motion);
+				dispatchTicks += SDL_GetPerformanceCounter() - dispatchStart;
+			}
+
+			controller.update();
+			controller.render();
+
+			frameTimes.add(toMilliseconds(SDL_GetPerformanceCounter() - frameStart));
+			dispatchTimes.add(toMilliseconds(dispatchTicks));
+			snapTimes.add(toMilliseconds(controller.takeSnapTicks()));
+			hudTimes.add(controller.getHudMilliseconds());
+			allocations.add(static_cast<double>(allocationsSoFar() - allocationsBefore));
+		}
+
+		metricsAfter = Metrics::getTotals();
+
+		SDL_Event up = mouseButtonEvent(SDL_MOUSEBUTTONUP, options.scenario == "pan" ? SDL_BUTTON_MIDDLE : SDL_BUTTON_LEFT, x, y);
+		controller.handleEvent(up);
+	}
+
+	std::printf("{\n");
+	std::printf("  \"scene\": \"%s\",\n", options.scene.c_str());
+	std::printf("  \"scenario\": \"%s\",\n", options.scenario.c_str());
+	std::printf("  \"count\": %zu,\n", options.count);
+	std::printf("  \"frames\": %d,\n", options.frames);
+	std::printf("  \"width\": %d,\n", options.width);
+	std::printf("  \"height\": %d,\n", options.height);
+	std::printf("  \"canvas_scale\": %d,\n", options.canvasScale);
+	std::printf("  \"zoom\": %g,\n", options.zoom);
+	std::printf("  \"lod_pixels\": %d,\n", options.lodPixels);
+	std::printf("  \"grid\": %d,\n", options.grid);
+	std::printf("  \"video_driver\": \"%s\",\n", SDL_GetCurrentVideoDriver());
+	frameTimes.print("frame_ms");
+	dispatchTimes.print("dispatch_ms");
+	snapTimes.print("snap_ms");
+	hudTimes.print("hud_ms");
+	allocations.print("allocations");
+
+	// Controller counters summed over the measured frames.
+	std::printf("  \"metrics\": {");
+	for (size_t i = 0; i < static_cast<size_t>(Metric::Count); ++i)
+	{
+		Metric metric = static_cast<Metric>(i);
+		std::printf("%s \"%s\": %llu", i ? "," : "", Metrics::getName(metric),
+			static_cast<unsigned long long>(metricsAfter[metric] - metricsBefore[metric]));
+	}
+	std::printf(" }\n");
+	std::printf("}\n");
+
+	SDL_DestroyRenderer(renderer);
+	SDL_FreeSurface(target);
+	SDL_Quit();
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+// Compares TileRasterizer against SDL's software renderer drawing the same
+// snapshot of 10k overlapping rectangles into a surface at 1080p and 4K.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <SDL2/SDL.h>
+
+#include "../JobSystem.h"
+#include "../RenderSnapshot.h"
+#include "../TileRasterizer.h"
+
+static RenderSnapshot makeScene(int width, int height, size_t count)
+{
+	std::mt19937 random(1234);
+	RenderSnapshot snapshot;
+	snapshot.items.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		int w = 20 + static_cast<int>(random() % (width / 5));
+		int h = 20 + static_cast<int>(random() % (height / 5));
+		snapshot.items.push_back({
+			SDL_Rect{ static_cast<int>(random() % width) - w / 2, static_cast<int>(random() % height) - h / 2, w, h },
+			SDL_Color{ static_cast<Uint8>(random()), static_cast<Uint8>(random()), static_cast<Uint8>(random()), 255 } });
+	}
+	return snapshot;
+}
+
+template <typename Fn>
+static double timeFrames(int frames, Fn&& drawFrame)
+{
+	drawFrame();
+
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < frames; ++frame)
+	{
+		drawFrame();
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / frames;
+}
+
+int main()
+{
+	SDL_Init(0);
+
+	const size_t rectCount = 10000;
+	const int frames = 10;
+	const struct { const char* name; int width; int height; } resolutions[] = {
+		{ "1080p", 1920, 1080 },
+		{ "4K", 3840, 2160 },
+	};
+
+	std::printf("resolution,backend,threads,frame_ms\n");
+
+	for (const auto& resolution : resolutions)
+	{
+		RenderSnapshot snapshot = makeScene(resolution.width, resolution.height, rectCount);
+
+		SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, resolution.width, resolution.height, 32, SDL_PIXELFORMAT_ARGB8888);
+		SDL_Renderer* software = SDL_CreateSoftwareRenderer(target);
+		double stock = timeFrames(frames, [&] { renderSnapshot(software, snapshot); });
+		std::printf("%s,sdl-software,1,%.3f\n", resolution.name, stock);
+		SDL_DestroyRenderer(software);
+
+		// Both paths must produce the same image.
+		TileRasterizer rasterizer(resolution.width, resolution.height, JobSystem::defaultWorkerCount());
+		rasterizer.rasterize(snapshot);
+		SDL_Surface* tiled = rasterizer.getSurface();
+		for (int y = 0; y < resolution.height; ++y)
+		{
+			if (SDL_memcmp(static_cast<Uint8*>(target->pixels) + y * target->pitch,
+				static_cast<Uint8*>(tiled->pixels) + y * tiled->pitch, resolution.width * 4) != 0)
+			{
+				std::fprintf(stderr, "%s: output differs from the SDL software renderer at row %d\n", resolution.name, y);
+				break;
+			}
+		}
+		SDL_FreeSurface(target);
+
+		for (size_t threads = 1; threads <= JobSystem::defaultWorkerCount() + 1; threads *= 2)
+		{
+			TileRasterizer timed(resolution.width, resolution.height, threads - 1);
+			double frameMs = timeFrames(frames, [&] { timed.rasterize(snapshot); });
+			std::printf("%s,tile-raster,%zu,%.3f\n", resolution.name, threads, frameMs);
+		}
+	}
+
+	SDL_Quit();
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,364 @@
+// Golden-image regression check for every rendering path. Scripted scenes are
+// built through GuiController, drawn into an offscreen software target, read
+// back with SDL_RenderReadPixels and hashed (MD5 and CRC32 from SDL_test).
+// The hashes are compared against bench/goldens/goldens.txt; on a mismatch the
+// actual image and a diff against the golden BMP are written out.
+//
+// Usage: render-golden [--update] [--out DIR]
+//   --update  re-record goldens from GuiController::render()
+//   --out     where actual/diff BMPs of failing cases go (default: .)
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_test_crc32.h>
+#include <SDL2/SDL_test_md5.h>
+
+#include "../DraggableRectangle.h"
+#include "../GuiController.h"
+#include "../JobSystem.h"
+#include "../TileRasterizer.h"
+
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR "bench/goldens"
+#endif
+
+static const int Width = 640;
+static const int Height = 480;
+
+struct Scene
+{
+	const char* name;
+	void (*build)(GuiController& controller, SDL_Renderer* renderer);
+};
+
+// Only std::mt19937 itself is specified exactly by the standard, so scenes
+// draw from it directly instead of through distributions.
+static int randomInt(std::mt19937& random, int min, int max)
+{
+	return min + static_cast<int>(random() % static_cast<unsigned int>(max - min + 1));
+}
+
+static SDL_Color randomColor(std::mt19937& random, Uint8 alpha = 255)
+{
+	return { static_cast<Uint8>(random() & 0xff), static_cast<Uint8>(random() & 0xff), static_cast<Uint8>(random() & 0xff), alpha };
+}
+
+static void sendMouse(GuiController& controller, Uint32 type, int x, int y)
+{
+	SDL_Event event = {};
+	event.type = type;
+	if (type == SDL_MOUSEMOTION)
+	{
+		event.motion.x = x;
+		event.motion.y = y;
+	}
+	else
+	{
+		event.button.button = SDL_BUTTON_LEFT;
+		event.button.x = x;
+		event.button.y = y;
+	}
+	controller.handleEvent(event);
+}
+
+static void buildDefault(GuiController& controller, SDL_Renderer* renderer)
+{
+	controller.addComponent(std::make_unique<DraggableRectangle>(renderer, SDL_Rect{ 50, 50, 100, 100 }, SDL_Color{ 200, 40, 40, 255 }));
+	controller.addComponent(std::make_unique<DraggableRectangle>(renderer, SDL_Rect{ 200, 200, 100, 100 }, SDL_Color{ 40, 200, 40, 255 }));
+	controller.addComponent(std::make_unique<DraggableRectangle>(renderer, SDL_Rect{ 400, 50, 150, 150 }, SDL_Color{ 40, 40, 200, 255 }));
+}
+
+static void buildDragSnap(GuiController& controller, SDL_Renderer* renderer)
+{
+	buildDefault(controller, renderer);
+
+	// Drag the middle rect to just left of the blue one and let it snap.
+	sendMouse(controller, SDL_MOUSEBUTTONDOWN, 250, 250);
+	sendMouse(controller, SDL_MOUSEMOTION, 300, 200);
+	sendMouse(controller, SDL_MOUSEMOTION, 345, 110);
+	sendMouse(controller, SDL_MOUSEBUTTONUP, 345, 110);
+}
+
+static void buildHover(GuiController& controller, SDL_Renderer* renderer)
+{
+	buildDefault(controller, renderer);
+
+	// Rest the pointer over the red rect so it is drawn tinted.
+	sendMouse(controller, SDL_MOUSEMOTION, 120, 90);
+}
+
+static void buildGrid(GuiController& controller, SDL_Renderer* renderer)
+{
+	controller.setGrid(40, 4);
+	buildDefault(controller, renderer);
+
+	// Drop the red rect off the grid lines so it snaps onto them.
+	sendMouse(controller, SDL_MOUSEBUTTONDOWN, 100, 100);
+	sendMouse(controller, SDL_MOUSEMOTION, 183, 147);
+	sendMouse(controller, SDL_MOUSEBUTTONUP, 183, 147);
+}
+
+static void buildOverlapStack(GuiController& controller, SDL_Renderer* renderer)
+{
+	std::mt19937 random(7);
+	for (int i = 0; i < 50; ++i)
+	{
+		// Some rects hang off the edges of the target.
+		SDL_Rect rect = { randomInt(random, -80, Width - 40), randomInt(random, -80, Height - 40), randomInt(random, 40, 300), randomInt(random, 40, 300) };
+		controller.addComponent(std::make_unique<DraggableRectangle>(renderer, rect, randomColor(random)));
+	}
+}
+
+static void buildDenseUniform(GuiController& controller, SDL_Renderer* renderer)
+{
+	std::mt19937 random(11);
+	for (int i = 0; i < 5000; ++i)
+	{
+		SDL_Rect rect = { randomInt(random, 0, Width), randomInt(random, 0, Height), randomInt(random, 2, 24), randomInt(random, 2, 24) };
+		controller.addComponent(std::make_unique<DraggableRectangle>(renderer, rect, randomColor(random)));
+	}
+}
+
+static void buildTranslucent(GuiController& controller, SDL_Renderer* renderer)
+{
+	// With the default SDL_BLENDMODE_NONE alpha is written, not blended.
+	std::mt19937 random(13);
+	for (int i = 0; i < 30; ++i)
+	{
+		SDL_Rect rect = { randomInt(random, 0, Width - 100), randomInt(random, 0, Height - 100), 100, 100 };
+		controller.addComponent(std::make_unique<DraggableRectangle>(renderer, rect, randomColor(random, static_cast<Uint8>(random() & 0xff))));
+	}
+}
+
+static const Scene scenes[] = {
+	{ "default", buildDefault },
+	{ "drag-snap", buildDragSnap },
+	{ "hover", buildHover },
+	{ "grid", buildGrid },
+	{ "overlap-stack", buildOverlapStack },
+	{ "dense-uniform", buildDenseUniform },
+	{ "translucent", buildTranslucent },
+};
+
+struct Image
+{
+	std::vector<Uint32> pixels;
+
+	std::string hash() const
+	{
+		auto* bytes = reinterpret_cast<unsigned char*>(const_cast<Uint32*>(pixels.data()));
+		unsigned int length = static_cast<unsigned int>(pixels.size() * sizeof(Uint32));
+
+		SDLTest_Md5Context md5;
+		SDLTest_Md5Init(&md5);
+		SDLTest_Md5Update(&md5, bytes, length);
+		SDLTest_Md5Final(&md5);
+
+		SDLTest_Crc32Context crcContext;
+		CrcUint32 crc = 0;
+		SDLTest_Crc32Init(&crcContext);
+		SDLTest_Crc32Calc(&crcContext, bytes, length, &crc);
+		SDLTest_Crc32Done(&crcContext);
+
+		char text[64];
+		for (int i = 0; i < 16; ++i)
+		{
+			SDL_snprintf(text + i * 2, 3, "%02x", md5.digest[i]);
+		}
+		SDL_snprintf(text + 32, sizeof(text) - 32, " %08x", crc);
+		return text;
+	}
+
+	SDL_Surface* toSurface() const
+	{
+		SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, Width, Height, 32, SDL_PIXELFORMAT_ARGB8888);
+		for (int y = 0; y < Height; ++y)
+		{
+			SDL_memcpy(static_cast<Uint8*>(surface->pixels) + y * surface->pitch, &pixels[static_cast<size_t>(y) * Width], Width * sizeof(Uint32));
+		}
+		return surface;
+	}
+};
+
+static Image readSurface(SDL_Surface* surface)
+{
+	Image image;
+	image.pixels.resize(static_cast<size_t>(Width) * Height);
+	SDL_ConvertPixels(Width, Height, surface->format->format, surface->pixels, surface->pitch,
+		SDL_PIXELFORMAT_ARGB8888, image.pixels.data(), Width * sizeof(Uint32));
+	return image;
+}
+
+static Image readRenderer(SDL_Renderer* renderer)
+{
+	Image image;
+	image.pixels.resize(static_cast<size_t>(Width) * Height);
+	SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, image.pixels.data(), Width * sizeof(Uint32));
+	return image;
+}
+
+// Renders a freshly built scene through each path.
+static std::map<std::string, Image> renderScene(const Scene& scene, SDL_Renderer* renderer, TileRasterizer& rasterizer)
+{
+	std::map<std::string, Image> images;
+
+	GuiController controller(renderer);
+	scene.build(controller, renderer);
+
+	controller.render();
+	images["controller"] = readRenderer(renderer);
+
+	RenderSnapshot snapshot;
+	controller.buildSnapshot(snapshot);
+	renderSnapshot(renderer, snapshot);
+	images["snapshot"] = readRenderer(renderer);
+
+	rasterizer.rasterize(snapshot);
+	images["tile-raster"] = readSurface(rasterizer.getSurface());
+
+	return images;
+}
+
+static void writeDiff(const Image& actual, const std::string& goldenPath, const std::string& prefix)
+{
+	SDL_Surface* actualSurface = actual.toSurface();
+	SDL_SaveBMP(actualSurface, (prefix + "-actual.bmp").c_str());
+	SDL_FreeSurface(actualSurface);
+
+	SDL_Surface* loaded = SDL_LoadBMP(goldenPath.c_str());
+	if (!loaded)
+	{
+		return;
+	}
+	SDL_Surface* golden = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+	SDL_FreeSurface(loaded);
+
+	// Differing pixels in red over a dimmed copy of the actual image.
+	Image diff = actual;
+	size_t differing = 0;
+	for (int y = 0; y < Height && y < golden->h; ++y)
+	{
+		auto* goldenRow = reinterpret_cast<Uint32*>(static_cast<Uint8*>(golden->pixels) + y * golden->pitch);
+		for (int x = 0; x < Width && x < golden->w; ++x)
+		{
+			Uint32& pixel = diff.pixels[static_cast<size_t>(y) * Width + x];
+			if (pixel != goldenRow[x])
+			{
+				pixel = 0xffff0000;
+				++differing;
+			}
+			else
+			{
+				Uint32 gray = (((pixel >> 16) & 0xff) + ((pixel >> 8) & 0xff) + (pixel & 0xff)) / 12;
+				pixel = 0xff000000 | (gray << 16) | (gray << 8) | gray;
+			}
+		}
+	}
+	SDL_FreeSurface(golden);
+
+	SDL_Surface* diffSurface = diff.toSurface();
+	SDL_SaveBMP(diffSurface, (prefix + "-diff.bmp").c_str());
+	SDL_FreeSurface(diffSurface);
+	std::printf("    %zu pixels differ, see %s-diff.bmp\n", differing, prefix.c_str());
+}
+
+static std::map<std::string, std::string> loadGoldens(const std::string& path)
+{
+	std::map<std::string, std::string> goldens;
+	std::ifstream file(path);
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream fields(line);
+		std::string name, md5, crc;
+		if (fields >> name >> md5 >> crc)
+		{
+			goldens[name] = md5 + " " + crc;
+		}
+	}
+	return goldens;
+}
+
+int main(int argc, char* argv[])
+{
+	bool update = false;
+	std::string outDir = ".";
+	for (int i = 1; i < argc; ++i)
+	{
+		if (SDL_strcmp(argv[i], "--update") == 0)
+		{
+			update = true;
+		}
+		else if (SDL_strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+		{
+			outDir = argv[++i];
+		}
+	}
+
+	SDL_Init(0);
+
+	SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, Width, Height, 32, SDL_PIXELFORMAT_ARGB8888);
+	SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(target);
+	TileRasterizer rasterizer(Width, Height, JobSystem::defaultWorkerCount());
+
+	std::string goldenDir = GOLDEN_DIR;
+	std::string goldenList = goldenDir + "/goldens.txt";
+	std::map<std::string, std::string> goldens = loadGoldens(goldenList);
+
+	std::ofstream updated;
+	if (update)
+	{
+		std::filesystem::create_directories(goldenDir);
+		updated.open(goldenList);
+	}
+
+	int failures = 0;
+	for (const Scene& scene : scenes)
+	{
+		std::map<std::string, Image> images = renderScene(scene, renderer, rasterizer);
+		std::string goldenBMP = goldenDir + "/" + scene.name + ".bmp";
+
+		if (update)
+		{
+			const Image& reference = images["controller"];
+			goldens[scene.name] = reference.hash();
+			updated << scene.name << " " << goldens[scene.name] << "\n";
+
+			SDL_Surface* surface = reference.toSurface();
+			SDL_SaveBMP(surface, goldenBMP.c_str());
+			SDL_FreeSurface(surface);
+		}
+
+		auto golden = goldens.find(scene.name);
+		for (const auto& entry : images)
+		{
+			std::string hash = entry.second.hash();
+			bool pass = golden != goldens.end() && golden->second == hash;
+			std::printf("%-4s %-14s %-12s %s\n", pass ? "ok" : "FAIL", scene.name, entry.first.c_str(), hash.c_str());
+			if (!pass)
+			{
+				++failures;
+				if (golden == goldens.end())
+				{
+					std::printf("    no golden recorded; run with --update\n");
+				}
+				writeDiff(entry.second, goldenBMP, outDir + "/" + scene.name + "-" + entry.first);
+			}
+		}
+	}
+
+	SDL_DestroyRenderer(renderer);
+	SDL_FreeSurface(target);
+	SDL_Quit();
+
+	std::printf("%d failing\n", failures);
+	return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+// Measures how the work-stealing JobSystem that GuiController::update() hands
+// thread-safe components to scales, on a synthetic workload: 100k components
+// whose update() does a small, uneven amount of independent work, run with 1,
+// 2, 4 and 8 threads. The controller itself always uses every core, so the
+// loop is driven directly. Rows with more threads
+// than the machine has hardware threads are marked, since their speedup only
+// shows the cost of oversubscription.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../GuiComponent.h"
+#include "../JobSystem.h"
+
+class AnimatedComponent : public GuiComponent
+{
+public:
+	AnimatedComponent(const SDL_Rect& rect, int iterations)
+		: GuiComponent(rect), _iterations(iterations) {}
+
+	AnimatedComponent* clone() const override
+	{
+		return new AnimatedComponent(*this);
+	}
+
+	void update() override
+	{
+		for (int i = 0; i < _iterations; ++i)
+		{
+			_phase += 0.01;
+			_offset = std::sin(_phase) * 10.0;
+		}
+		getRect().x = _baseX + static_cast<int>(_offset);
+	}
+
+	bool isUpdateThreadSafe() const override
+	{
+		return true;
+	}
+
+private:
+	int _iterations;
+	int _baseX = getRect().x;
+	double _phase = 0.0;
+	double _offset = 0.0;
+};
+
+int main()
+{
+	const size_t componentCount = 100000;
+	const int frames = 50;
+
+	std::vector<std::unique_ptr<GuiComponent>> components;
+	components.reserve(componentCount);
+	for (size_t i = 0; i < componentCount; ++i)
+	{
+		// Every 16th component is eight times as expensive, so static
+		// partitioning would leave some threads idle.
+		int iterations = i % 16 == 0 ? 64 : 8;
+		components.push_back(std::make_unique<AnimatedComponent>(
+			SDL_Rect{ static_cast<int>(i % 1000) * 10, static_cast<int>(i / 1000) * 10, 8, 8 }, iterations));
+	}
+
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	std::printf("threads,frame_ms,speedup,oversubscribed\n");
+
+	double baseline = 0.0;
+	for (size_t threads : { 1, 2, 4, 8 })
+	{
+		JobSystem jobs(threads - 1);
+		auto updateAll = [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					components[i]->update();
+				}
+			};
+
+		// Warm up once so thread start-up is not measured.
+		jobs.parallelFor(components.size(), 256, updateAll);
+
+		auto start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			jobs.parallelFor(components.size(), 256, updateAll);
+		}
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		double frameMs = elapsed.count() / frames;
+		if (threads == 1)
+		{
+			baseline = frameMs;
+		}
+		std::printf("%zu,%.3f,%.2f,%d\n", threads, frameMs, baseline / frameMs, hardwareThreads > 0 && threads > hardwareThreads ? 1 : 0);
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -1,9 +1,21 @@
+#include <atomic>
+#include <cstdio>
 #include <iostream>
+#include <thread>
 #include <vector>
 #include <SDL2/SDL.h>
 
+#include "AllocationTracker.h"
+#include "AutosaveJournal.h"
 #include "DraggableRectangle.h"
+#include "FrameArena.h"
 #include "GuiController.h"
+#include "Metrics.h"
+#include "Minimap.h"
+#include "RenderSnapshot.h"
+#include "SpscQueue.h"
+#include "TileRasterizer.h"
+#include "TripleBuffer.h"
 
 SDL_Color getRandomColor() 
 {
@@ -14,59 +26,363 @@ SDL_Color getRandomColor()
 	return color;
 }
 
-int main(int argc, char* argv[]) 
+bool isQuitEvent(const SDL_Event& event)
 {
-	SDL_Init(SDL_INIT_VIDEO);
+	return event.type == SDL_QUIT ||
+		(event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE);
+}
 
-	SDL_Window* window = SDL_CreateWindow(
-		"Draggable Rectangles", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 640, 480, SDL_WINDOW_SHOWN);
-	SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, 0);
+void handleAppEvent(GuiController& controller, SDL_Renderer* renderer, const SDL_Event& event)
+{
+	if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_r && event.key.keysym.mod & KMOD_CTRL) 
+	{
+		// Somewhere in view, wherever the camera is
+		SDL_Point at = controller.getCamera().toWorld(rand() % 500, rand() % 300);
+		controller.addComponent(std::make_unique<DraggableRectangle>(
+			renderer, SDL_Rect{ at.x, at.y, 100, 100 }, getRandomColor()));
+	}
+	else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_h && event.key.keysym.mod & KMOD_CTRL)
+	{
+		controller.setHudVisible(!controller.isHudVisible());
+	}
+	else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_g && event.key.keysym.mod & KMOD_CTRL)
+	{
+		controller.setGrid(controller.getGridSpacing() > 0 ? 0 : 100, 4);
+	}
+	else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_c && event.key.keysym.mod & KMOD_CTRL) 
+	{
+		// Recolor the rectangle under the mouse. The controller's pointer is
+		// where the mouse was as of this event, even on the simulation thread.
+		SDL_Point pointer = controller.getPointerPosition();
+		int index = controller.findComponentAt(pointer.x, pointer.y);
+		if (index >= 0)
+		{
+			controller.setComponentColor(index, getRandomColor());
+		}
+	}
+	else 
+	{
+		// Handle events with the GuiController
+		controller.handleEvent(event);
+	}
+}
 
-	// Create a new GuiController object
-	GuiController controller(renderer);
+// Appends event to the frame's event list, folding a run of mouse motion into
+// its last event: components only look at where the pointer ended up, so one
+// drag step (and one snap search) per run is enough.
+template <typename Events>
+void appendCoalesced(Events& events, const SDL_Event& event)
+{
+	if (event.type == SDL_MOUSEMOTION && !events.empty())
+	{
+		SDL_MouseMotionEvent& previous = events.back().motion;
+		if (previous.type == SDL_MOUSEMOTION && previous.windowID == event.motion.windowID &&
+			previous.which == event.motion.which && previous.state == event.motion.state)
+		{
+			int xrel = previous.xrel + event.motion.xrel;
+			int yrel = previous.yrel + event.motion.yrel;
+			previous = event.motion;
+			previous.xrel = xrel;
+			previous.yrel = yrel;
+			return;
+		}
+	}
 
-	SDL_Rect initialRect = { 50, 50, 100, 100 };
+	events.push_back(event);
+}
 
-	// Add a few DraggableRectangle objects to the GuiController
-	controller.addComponent(std::make_unique<DraggableRectangle>(
-		renderer, initialRect, getRandomColor()));
-	controller.addComponent(std::make_unique<DraggableRectangle>(
-		renderer, SDL_Rect{ 200, 200, 100, 100 }, getRandomColor()));
-	controller.addComponent(std::make_unique<DraggableRectangle>(
-		renderer, SDL_Rect{ 400, 50, 150, 150 }, getRandomColor()));
+// Keeps the tile rasterizer, if there is one, the size of the window's output.
+void resizeRasterizer(SDL_Renderer* renderer, TileRasterizer* rasterizer, const SDL_Event& event)
+{
+	if (rasterizer && event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+	{
+		int width, height;
+		SDL_GetRendererOutputSize(renderer, &width, &height);
+		rasterizer->resize(width, height);
+	}
+}
 
+// Draws a snapshot with the SDL renderer, or with the tile rasterizer if one is given.
+void drawSnapshot(SDL_Renderer* renderer, TileRasterizer* rasterizer, const RenderSnapshot& snapshot)
+{
+	if (rasterizer)
+	{
+		rasterizer->rasterize(snapshot);
+		rasterizer->present(renderer);
+	}
+	else
+	{
+		renderSnapshot(renderer, snapshot);
+	}
+}
+
+// Events, updates and rendering one after another on the main thread.
+void runSequential(GuiController& controller, SDL_Renderer* renderer, TileRasterizer* rasterizer)
+{
+	RenderSnapshot snapshot;
 	bool running = true;
 	while (running) 
 	{
+		FrameVector<SDL_Event> events(controller.getFrameArena());
 		SDL_Event event;
 		while (SDL_PollEvent(&event)) 
 		{
-			if (event.type == SDL_QUIT) 
+			if (isQuitEvent(event)) 
 			{
 				running = false;
 			}
-			else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) 
+			else 
 			{
-				running = false;
+				resizeRasterizer(renderer, rasterizer, event);
+				appendCoalesced(events, event);
 			}
-			else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_r && SDL_GetModState() & KMOD_CTRL) 
+		}
+
+		for (const SDL_Event& coalesced : events)
+		{
+			handleAppEvent(controller, renderer, coalesced);
+		}
+
+		SDL_Delay(10);
+
+		controller.update();
+
+		// Render the GUI with the GuiController
+		if (rasterizer)
+		{
+			controller.buildSnapshot(snapshot);
+			drawSnapshot(renderer, rasterizer, snapshot);
+		}
+		else
+		{
+			controller.render();
+		}
+	}
+}
+
+// The main thread polls events and renders while a simulation thread owns the
+// controller: it handles the forwarded events, updates the components and
+// publishes an immutable snapshot of the next frame. Neither side waits for
+// the other; the renderer always draws the newest published frame.
+void runPipelined(GuiController& controller, SDL_Renderer* renderer, TileRasterizer* rasterizer)
+{
+	SpscQueue<SDL_Event> events(4096);
+	TripleBuffer<RenderSnapshot> frames;
+	std::atomic<bool> running{ true };
+
+	// Events the queue had no room for, kept in order until it does. Motion
+	// is coalesced here too, but nothing is dropped: a lost button release
+	// would leave a component dragging.
+	std::vector<SDL_Event> deferred;
+	deferred.reserve(64);
+
+	std::thread simulation([&]
+		{
+			while (running.load(std::memory_order_acquire))
 			{
-				controller.addComponent(std::make_unique<DraggableRectangle>(
-					renderer, SDL_Rect{ rand() % 500, rand() % 300, 100, 100 }, getRandomColor()));
+				FrameVector<SDL_Event> frameEvents(controller.getFrameArena());
+				SDL_Event event;
+				while (events.tryPop(event))
+				{
+					appendCoalesced(frameEvents, event);
+				}
+
+				for (const SDL_Event& coalesced : frameEvents)
+				{
+					handleAppEvent(controller, renderer, coalesced);
+				}
+
+				controller.update();
+				controller.buildSnapshot(frames.getWriteBuffer());
+				frames.publish();
+
+				SDL_Delay(10);
 			}
-			else 
+		});
+
+	while (running.load(std::memory_order_relaxed))
+	{
+		size_t sent = 0;
+		while (sent < deferred.size() && events.tryPush(deferred[sent]))
+		{
+			++sent;
+		}
+		deferred.erase(deferred.begin(), deferred.begin() + sent);
+
+		SDL_Event event;
+		while (SDL_PollEvent(&event))
+		{
+			if (isQuitEvent(event))
+			{
+				running.store(false, std::memory_order_release);
+			}
+			else
 			{
-				// Handle events with the GuiController
-				controller.handleEvent(event);
+				// The rasterizer belongs to this thread; the controller's
+				// viewport follows when the simulation handles the event.
+				resizeRasterizer(renderer, rasterizer, event);
+				if (!deferred.empty() || !events.tryPush(event))
+				{
+					Metrics::add(Metric::EventsDeferred);
+					appendCoalesced(deferred, event);
+				}
 			}
 		}
 
-		SDL_Delay(10);
+		if (frames.acquire())
+		{
+			drawSnapshot(renderer, rasterizer, frames.getReadBuffer());
+		}
+		else
+		{
+			SDL_Delay(1);
+		}
+	}
 
-		// Render the GUI with the GuiController
-		controller.render();
+	simulation.join();
+}
+
+int main(int argc, char* argv[]) 
+{
+	// Route SDL's allocations through the tracker before SDL makes any
+	AllocationTracker::install();
+
+	bool pipelined = false;
+	bool tileRaster = false;
+	bool showHud = false;
+	bool picking = false;
+	const char* metricsPath = nullptr;
+	Uint32 metricsInterval = 1000;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (SDL_strcmp(argv[i], "--pipelined") == 0)
+		{
+			pipelined = true;
+		}
+		else if (SDL_strcmp(argv[i], "--tile-raster") == 0)
+		{
+			tileRaster = true;
+		}
+		else if (SDL_strcmp(argv[i], "--alloc-log") == 0 && i + 1 < argc)
+		{
+			if (!AllocationTracker::Enabled)
+			{
+				std::cerr << "--alloc-log needs a build with GUI_TRACK_ALLOCATIONS" << std::endl;
+			}
+			if (!AllocationTracker::openLog(argv[++i]) && AllocationTracker::Enabled)
+			{
+				std::cerr << "Could not open allocation log " << argv[i] << std::endl;
+			}
+		}
+		else if (SDL_strcmp(argv[i], "--assert-steady-allocs") == 0)
+		{
+			AllocationTracker::setAssertSteadyState(true);
+		}
+		else if (SDL_strcmp(argv[i], "--hud") == 0)
+		{
+			showHud = true;
+		}
+		else if (SDL_strcmp(argv[i], "--picking") == 0)
+		{
+			picking = true;
+		}
+		else if (SDL_strcmp(argv[i], "--metrics") == 0 && i + 1 < argc)
+		{
+			// A path, or "-" for stdout
+			metricsPath = argv[++i];
+		}
+		else if (SDL_strcmp(argv[i], "--metrics-interval") == 0 && i + 1 < argc)
+		{
+			metricsInterval = static_cast<Uint32>(SDL_atoi(argv[++i]));
+		}
+	}
+
+	SDL_Init(SDL_INIT_VIDEO);
+
+	std::FILE* metricsFile = nullptr;
+	if (metricsPath)
+	{
+		metricsFile = SDL_strcmp(metricsPath, "-") == 0 ? stdout : std::fopen(metricsPath, "w");
+		if (!metricsFile)
+		{
+			std::cerr << "Could not open metrics file " << metricsPath << std::endl;
+		}
+		Metrics::setDumpFile(metricsFile, metricsInterval);
+	}
+
+	// The window only looks onto the canvas: drag with the middle button to
+	// pan and use the wheel to zoom.
+	SDL_Window* window = SDL_CreateWindow(
+		"Draggable Rectangles", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 640, 480, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
+	SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, 0);
+
+	// Create a new GuiController object
+	GuiController controller(renderer);
+
+	// The HUD is drawn by GuiController::render, which the pipelined and
+	// tile-raster paths do not use.
+	controller.setHudVisible(showHud);
+	controller.setPickingBuffer(picking);
+
+	// Recover the previous session, if any, before recording new edits
+	AutosaveJournal journal("autosave");
+	for (const SceneItem& item : journal.getRestoredScene())
+	{
+		controller.addComponent(std::make_unique<DraggableRectangle>(
+			renderer, item.rect, item.color));
+	}
+	bool restored = !journal.getRestoredScene().empty();
+	controller.setJournal(&journal);
+
+	if (!restored)
+	{
+		SDL_Rect initialRect = { 50, 50, 100, 100 };
+
+		// Add a few DraggableRectangle objects to the GuiController
+		controller.addComponent(std::make_unique<DraggableRectangle>(
+			renderer, initialRect, getRandomColor()));
+		controller.addComponent(std::make_unique<DraggableRectangle>(
+			renderer, SDL_Rect{ 200, 200, 100, 100 }, getRandomColor()));
+		controller.addComponent(std::make_unique<DraggableRectangle>(
+			renderer, SDL_Rect{ 400, 50, 150, 150 }, getRandomColor()));
+	}
+
+	// Overview of the canvas around the initial view, eight windows across.
+	// Like the HUD it is only drawn by GuiController::render, so the snapshot
+	// paths go without it rather than have an invisible area take clicks.
+	if (!pipelined && !tileRaster)
+	{
+		int width, height;
+		SDL_GetRendererOutputSize(renderer, &width, &height);
+		controller.addOverlay(std::make_unique<Minimap>(renderer, controller,
+			SDL_Rect{ width - 170, 10, 160, 120 }, SDL_Rect{ -2240, -1680, 5120, 3840 }));
+	}
+
+	// Rasterize on the CPU across all cores instead of using the SDL renderer
+	std::unique_ptr<TileRasterizer> rasterizer;
+	if (tileRaster)
+	{
+		int width, height;
+		SDL_GetRendererOutputSize(renderer, &width, &height);
+		rasterizer = std::make_unique<TileRasterizer>(width, height, JobSystem::defaultWorkerCount());
+	}
+
+	if (pipelined)
+	{
+		runPipelined(controller, renderer, rasterizer.get());
+	}
+	else
+	{
+		runSequential(controller, renderer, rasterizer.get());
+	}
+
+	Metrics::setDumpFile(nullptr);
+	if (metricsFile && metricsFile != stdout)
+	{
+		std::fclose(metricsFile);
 	}
 
+	rasterizer.reset();
 	SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
 	SDL_Quit();